@@ -0,0 +1,54 @@
+/**
+ * @brief Application overrides of the default FreeRTOS configuration. The
+ * project directory comes first in the include path, so this file is found
+ * instead of the default one, which is then pulled in with include_next.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef ESWGPIO_FREERTOSCONFIG_H_
+#define ESWGPIO_FREERTOSCONFIG_H_
+
+#include_next "FreeRTOSConfig.h"
+
+// Run-time statistics from the DWT cycle counter, see cpuload.h
+#undef configGENERATE_RUN_TIME_STATS
+#define configGENERATE_RUN_TIME_STATS 1
+#undef configUSE_TRACE_FACILITY
+#define configUSE_TRACE_FACILITY 1
+#undef INCLUDE_xTaskGetIdleTaskHandle
+#define INCLUDE_xTaskGetIdleTaskHandle 1
+
+// The modules give the control blocks of their timers and queues with
+// cb_mem, and main.c the thread memory, CMSIS-FreeRTOS creates nothing
+// from given memory without static allocation. The heap stays available.
+#undef configSUPPORT_STATIC_ALLOCATION
+#define configSUPPORT_STATIC_ALLOCATION 1
+
+#ifndef __ASSEMBLER__
+#include <stdint.h>
+void cpuload_timer_init (void);
+uint32_t cpuload_timer_get (void);
+void cpuload_switched_in (void);
+void cpuload_switched_out (void);
+#endif//__ASSEMBLER__
+
+#undef portCONFIGURE_TIMER_FOR_RUN_TIME_STATS
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() cpuload_timer_init()
+#undef portGET_RUN_TIME_COUNTER_VALUE
+#define portGET_RUN_TIME_COUNTER_VALUE() cpuload_timer_get()
+#undef traceTASK_SWITCHED_IN
+#define traceTASK_SWITCHED_IN() cpuload_switched_in()
+#undef traceTASK_SWITCHED_OUT
+#define traceTASK_SWITCHED_OUT() cpuload_switched_out()
+
+// Tick timestamps for the LED latency channel, see latency.h
+#ifdef LATENCY_TRACE
+#ifndef __ASSEMBLER__
+#include "latency.h"
+#endif//__ASSEMBLER__
+#undef traceTASK_INCREMENT_TICK
+#define traceTASK_INCREMENT_TICK(xTickCount) latency_start(LATENCY_TICK_LED)
+#endif//LATENCY_TRACE
+
+#endif//ESWGPIO_FREERTOSCONFIG_H_
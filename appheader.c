@@ -0,0 +1,63 @@
+/**
+ * @brief Application header view.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include "appheader.h"
+
+#include <stddef.h>
+#include <string.h>
+
+// Embedded in appheader_data.c
+#include "incbin.h"
+INCBIN_EXTERN(Header);
+
+static bool m_checked;
+static const appheader_t * m_header;
+static appheader_version_t m_version = { 0, 0, 0, "" };
+
+static bool terminated (const char * s, uint32_t len)
+{
+    return memchr(s, '\0', len) != NULL;
+}
+
+const appheader_t * appheader_parse (const void *data, uint32_t len)
+{
+    const appheader_t * h = data;
+
+    if ((data == NULL) || (len < sizeof(appheader_t)))
+    {
+        return NULL;
+    }
+    if ((h->header_size != len)
+     || !terminated(h->version, sizeof(h->version))
+     || !terminated(h->name, sizeof(h->name)))
+    {
+        return NULL;
+    }
+    return h;
+}
+
+const appheader_t * appheader_get (void)
+{
+    if (!m_checked)
+    {
+        m_header = appheader_parse(gHeaderData, gHeaderSize);
+        if (m_header != NULL)
+        {
+            m_version.major = m_header->versionbin[0];
+            m_version.minor = m_header->versionbin[1];
+            m_version.patch = m_header->versionbin[2];
+            m_version.str = m_header->version;
+        }
+        m_checked = true;
+    }
+    return m_header;
+}
+
+const appheader_version_t * appheader_version (void)
+{
+    appheader_get();
+    return &m_version;
+}
@@ -0,0 +1,74 @@
+/**
+ * @brief Read-only view of the application header embedded from
+ * header.bin, parsed in place in flash.
+ *
+ * The field layout is written by hand from the HEADEREDIT fields set in
+ * the Makefile. The firmware build reads every field of the new
+ * header.bin back with tools/appheader_check.c and compares it with the
+ * value given to HEADEREDIT, so a layout mismatch fails the build. At run
+ * time a header is accepted only if its own size field matches the
+ * embedded size and its strings are terminated.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef APPHEADER_H_
+#define APPHEADER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define APPHEADER_VERSION_LEN 16
+#define APPHEADER_NAME_LEN    16
+#define APPHEADER_UUID_LEN    16
+
+typedef struct __attribute__((packed))
+{
+    uint8_t header_version;
+    uint8_t softtype;
+    uint16_t header_size;
+    uint32_t firmaddr;
+    uint32_t firmsizemax;
+    uint32_t size;                           // Image size, bytes
+    uint16_t crc;                            // Image CRC-16/CCITT
+    uint16_t reserved;
+    uint8_t versionbin[4];                   // Major, minor, patch, 0
+    char version[APPHEADER_VERSION_LEN];     // Version string
+    uint8_t uuid_board[APPHEADER_UUID_LEN];
+    uint8_t uuid_platform[APPHEADER_UUID_LEN];
+    uint8_t uuid_application[APPHEADER_UUID_LEN];
+    uint32_t timestamp;                      // Build time, UNIX seconds
+    char name[APPHEADER_NAME_LEN];           // Project name
+} appheader_t;
+
+typedef struct
+{
+    uint8_t major;
+    uint8_t minor;
+    uint8_t patch;
+    const char * str;
+} appheader_version_t;
+
+/**
+ * Check a header in memory, used for the embedded one and for header
+ * files read elsewhere.
+ *
+ * @param data Header bytes.
+ * @param len  Number of bytes available.
+ * @return The header or NULL if it does not match the layout.
+ */
+const appheader_t * appheader_parse (const void *data, uint32_t len);
+
+/**
+ * @return The embedded header or NULL if it is not valid, checked on the
+ *         first call only.
+ */
+const appheader_t * appheader_get (void);
+
+/**
+ * @return Version of the embedded header, decoded on the first call.
+ *         Zero with an empty string if the header is not valid.
+ */
+const appheader_version_t * appheader_version (void);
+
+#endif//APPHEADER_H_
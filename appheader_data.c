@@ -0,0 +1,12 @@
+/**
+ * @brief Application header binary created by HEADEREDIT, kept apart
+ * from the parser in appheader.c so that builds without header.bin can
+ * link their own data.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include "incbin.h"
+
+// Include the information header binary
+INCBIN(Header, "header.bin");
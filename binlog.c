@@ -0,0 +1,59 @@
+/**
+ * @brief Binary deferred-format log encoder.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include "binlog.h"
+
+#include <string.h>
+
+#include "cmsis_os2.h"
+
+static binlog_sink_f m_sink;
+
+static void put32 (uint8_t * buf, uint32_t value)
+{
+    buf[0] = value;
+    buf[1] = value >> 8;
+    buf[2] = value >> 16;
+    buf[3] = value >> 24;
+}
+
+void binlog_init (binlog_sink_f sink)
+{
+    m_sink = sink;
+}
+
+int logger_binlog (const char *ptr, int len)
+{
+    uint8_t buf[2 + BINLOG_TEXT_MAX];
+
+    if (m_sink != NULL)
+    {
+        uint8_t l = (len < BINLOG_TEXT_MAX) ? len : BINLOG_TEXT_MAX;
+        buf[0] = BINLOG_TEXT;
+        buf[1] = l;
+        memcpy(&buf[2], ptr, l);
+        m_sink((const char *)buf, 2 + l);
+    }
+    return len;
+}
+
+void binlog_write (uint32_t fmt, uint8_t count, const uint32_t *args)
+{
+    uint8_t buf[2 + 4 + 4 + 4 * BINLOG_ARGS_MAX];
+
+    if (m_sink != NULL)
+    {
+        buf[0] = BINLOG_RECORD;
+        buf[1] = count;
+        put32(&buf[2], fmt);
+        put32(&buf[6], osKernelGetTickCount());
+        for (uint8_t i = 0; i < count; i++)
+        {
+            put32(&buf[10 + 4 * i], args[i]);
+        }
+        m_sink((const char *)buf, 10 + 4 * count);
+    }
+}
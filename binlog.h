@@ -0,0 +1,83 @@
+/**
+ * @brief Binary deferred-format logging. A binlog record holds only the
+ * address of the format string, a timestamp and up to 4 integer arguments.
+ * Format strings are placed into the .binlog_fmt ELF section that is not
+ * loaded to the device, tools/binlog_decode.py expands records with the
+ * strings from the ELF file.
+ *
+ * Regular text log messages are wrapped into text records, so the binary
+ * mode plugs in through log_init() like the fwrite logger:
+ *
+ *     binlog_init(&logger_fwrite);
+ *     log_init(BASE_LOG_LEVEL, &logger_binlog, NULL);
+ *
+ * When LOGGER_BINLOG is not defined the binfo1 and bwarn1 macros fall
+ * back to info1 and warn1. In binary mode they are not filtered by the
+ * module log level.
+ *
+ * Stream format, little endian:
+ *   text:   0xB0, len, len bytes of text
+ *   binary: 0xB1, argument count, format address u32, tick u32, arguments u32
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef BINLOG_H_
+#define BINLOG_H_
+
+#include <stdint.h>
+
+#define BINLOG_TEXT   0xB0
+#define BINLOG_RECORD 0xB1
+
+#define BINLOG_ARGS_MAX 4
+
+// Longer text messages are truncated, a text record must fit a log ring slot
+#ifndef BINLOG_TEXT_MAX
+#define BINLOG_TEXT_MAX 124
+#endif//BINLOG_TEXT_MAX
+
+#ifdef LOGGER_BINLOG
+
+typedef int (*binlog_sink_f)(const char *ptr, int len);
+
+/**
+ * Set the output for encoded records, for example logger_fwrite.
+ */
+void binlog_init (binlog_sink_f sink);
+
+/**
+ * Log output function for log_init(), wraps text messages into records.
+ */
+int logger_binlog (const char *ptr, int len);
+
+/**
+ * Emit a binary record, use the binlog macros instead.
+ */
+void binlog_write (uint32_t fmt, uint8_t count, const uint32_t *args);
+
+// Non-allocated section, the '@' comments out the flags GCC appends
+#ifndef BINLOG_SECTION
+#define BINLOG_SECTION ".binlog_fmt,\"\",%progbits @"
+#endif//BINLOG_SECTION
+
+// The argument count comes from the size of the argument array, the
+// leading 0 keeps the array non-empty without arguments
+#define BINLOG(level, fmt, ...) do { \
+    static const char __attribute__((section(BINLOG_SECTION), used)) _binlog_fmt[] = level "|" __MODUUL__ "|" fmt; \
+    const uint32_t _binlog_args[] = { 0, ##__VA_ARGS__ }; \
+    _Static_assert(sizeof(_binlog_args) / sizeof(uint32_t) - 1 <= BINLOG_ARGS_MAX, "too many binlog arguments"); \
+    binlog_write((uint32_t)(uintptr_t)_binlog_fmt, sizeof(_binlog_args) / sizeof(uint32_t) - 1, &_binlog_args[1]); \
+} while (0)
+
+#define binfo1(fmt, ...) BINLOG("I", fmt, ##__VA_ARGS__)
+#define bwarn1(fmt, ...) BINLOG("W", fmt, ##__VA_ARGS__)
+
+#else
+
+#define binfo1(fmt, ...) info1(fmt, ##__VA_ARGS__)
+#define bwarn1(fmt, ...) warn1(fmt, ##__VA_ARGS__)
+
+#endif//LOGGER_BINLOG
+
+#endif//BINLOG_H_
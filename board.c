@@ -0,0 +1,85 @@
+/**
+ * @brief Board pin configuration generated from BOARD_PINS.
+ *
+ * Each macro below folds the pin map into a constant for one port. The
+ * port loop in board_init() is unrolled by the preprocessor and the
+ * writes for ports without pins are removed by the compiler.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include "board.h"
+
+#include "em_cmu.h"
+
+#include "retargetserial.h"
+
+#define BOARD_PORTS 12 // GPIO->P entries
+
+#define BOARD_OR_(port, pt, pn, mode, out)    | (((pt) == (port)) ? (1UL << (pn)) : 0)
+#define BOARD_SUM_(port, pt, pn, mode, out)   + (((pt) == (port)) ? (1UL << (pn)) : 0)
+#define BOARD_DOUT_(port, pt, pn, mode, out)  | ((((pt) == (port)) && (out)) ? (1UL << (pn)) : 0)
+#define BOARD_MODEL_(port, pt, pn, mode, out) | ((((pt) == (port)) && ((pn) < 8)) ? ((uint32_t)(mode) << (((pn) & 7) * 4)) : 0)
+#define BOARD_MODEH_(port, pt, pn, mode, out) | ((((pt) == (port)) && ((pn) >= 8)) ? ((uint32_t)(mode) << (((pn) & 7) * 4)) : 0)
+#define BOARD_LMASK_(port, pt, pn, mode, out) | ((((pt) == (port)) && ((pn) < 8)) ? (0xFUL << (((pn) & 7) * 4)) : 0)
+#define BOARD_HMASK_(port, pt, pn, mode, out) | ((((pt) == (port)) && ((pn) >= 8)) ? (0xFUL << (((pn) & 7) * 4)) : 0)
+#define BOARD_MAXPORT_(port, pt, pn, mode, out) | (((pt) >= BOARD_PORTS) ? 1 : 0)
+
+// Expand the pin pair of an entry into port and pin number
+#define BOARD_OR(port, role, pin, mode, out)      BOARD_OR_(port, pin, mode, out)
+#define BOARD_SUM(port, role, pin, mode, out)     BOARD_SUM_(port, pin, mode, out)
+#define BOARD_DOUT(port, role, pin, mode, out)    BOARD_DOUT_(port, pin, mode, out)
+#define BOARD_MODEL(port, role, pin, mode, out)   BOARD_MODEL_(port, pin, mode, out)
+#define BOARD_MODEH(port, role, pin, mode, out)   BOARD_MODEH_(port, pin, mode, out)
+#define BOARD_LMASK(port, role, pin, mode, out)   BOARD_LMASK_(port, pin, mode, out)
+#define BOARD_HMASK(port, role, pin, mode, out)   BOARD_HMASK_(port, pin, mode, out)
+#define BOARD_MAXPORT(port, role, pin, mode, out) BOARD_MAXPORT_(port, pin, mode, out)
+
+#define BOARD_PORT_PINS(port)  (0 BOARD_PINS(BOARD_OR, port))
+#define BOARD_PORT_SUM(port)   (0 BOARD_PINS(BOARD_SUM, port))
+#define BOARD_PORT_DOUT(port)  (0 BOARD_PINS(BOARD_DOUT, port))
+#define BOARD_PORT_MODEL(port) (0 BOARD_PINS(BOARD_MODEL, port))
+#define BOARD_PORT_MODEH(port) (0 BOARD_PINS(BOARD_MODEH, port))
+#define BOARD_PORT_LMASK(port) (0 BOARD_PINS(BOARD_LMASK, port))
+#define BOARD_PORT_HMASK(port) (0 BOARD_PINS(BOARD_HMASK, port))
+
+// A pin listed twice makes the sum of the pin bits differ from their union
+#define BOARD_PORT_CHECK(port) \
+    _Static_assert(BOARD_PORT_PINS(port) == BOARD_PORT_SUM(port), "pin used twice on port " #port)
+
+_Static_assert((0 BOARD_PINS(BOARD_MAXPORT, 0)) == 0, "pin on a port beyond GPIO->P");
+BOARD_PORT_CHECK(0); BOARD_PORT_CHECK(1); BOARD_PORT_CHECK(2);  BOARD_PORT_CHECK(3);
+BOARD_PORT_CHECK(4); BOARD_PORT_CHECK(5); BOARD_PORT_CHECK(6);  BOARD_PORT_CHECK(7);
+BOARD_PORT_CHECK(8); BOARD_PORT_CHECK(9); BOARD_PORT_CHECK(10); BOARD_PORT_CHECK(11);
+
+// Board pins must stay clear of the serial port
+#if defined(RETARGET_TXPORT) && defined(RETARGET_TXPIN)
+_Static_assert((BOARD_PORT_PINS(RETARGET_TXPORT) & (1UL << RETARGET_TXPIN)) == 0, "pin used by serial TX");
+#endif
+#if defined(RETARGET_RXPORT) && defined(RETARGET_RXPIN)
+_Static_assert((BOARD_PORT_PINS(RETARGET_RXPORT) & (1UL << RETARGET_RXPIN)) == 0, "pin used by serial RX");
+#endif
+
+// Outputs get their level before the mode switches them on
+#define BOARD_PORT_INIT(port) \
+    if (BOARD_PORT_PINS(port) != 0) \
+    { \
+        GPIO->P[port].DOUT = (GPIO->P[port].DOUT & ~BOARD_PORT_PINS(port)) | BOARD_PORT_DOUT(port); \
+        if (BOARD_PORT_LMASK(port) != 0) \
+        { \
+            GPIO->P[port].MODEL = (GPIO->P[port].MODEL & ~BOARD_PORT_LMASK(port)) | BOARD_PORT_MODEL(port); \
+        } \
+        if (BOARD_PORT_HMASK(port) != 0) \
+        { \
+            GPIO->P[port].MODEH = (GPIO->P[port].MODEH & ~BOARD_PORT_HMASK(port)) | BOARD_PORT_MODEH(port); \
+        } \
+    }
+
+void board_init (void)
+{
+    CMU_ClockEnable(cmuClock_GPIO, true);
+
+    BOARD_PORT_INIT(0); BOARD_PORT_INIT(1); BOARD_PORT_INIT(2);  BOARD_PORT_INIT(3);
+    BOARD_PORT_INIT(4); BOARD_PORT_INIT(5); BOARD_PORT_INIT(6);  BOARD_PORT_INIT(7);
+    BOARD_PORT_INIT(8); BOARD_PORT_INIT(9); BOARD_PORT_INIT(10); BOARD_PORT_INIT(11);
+}
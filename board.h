@@ -0,0 +1,31 @@
+/**
+ * @brief Board pin map, every GPIO pin the application uses with its mode
+ * and initial level. board_init() configures them all with one write of
+ * DOUT, MODEL and MODEH per port, the register values are computed at
+ * compile time. Pins used twice are rejected at build time.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef BOARD_H_
+#define BOARD_H_
+
+#include "em_gpio.h"
+
+#include "pins.h"
+
+// arg, role, pin, mode, initial DOUT (pull direction for inputs)
+#define BOARD_PINS(X, arg) \
+    X(arg, LED_RED,   PIN_LED_RED,   gpioModePushPull,  0) \
+    X(arg, LED_GREEN, PIN_LED_GREEN, gpioModePushPull,  0) \
+    X(arg, LED_BLUE,  PIN_LED_BLUE,  gpioModePushPull,  0) \
+    X(arg, BUTTON,    PIN_BUTTON,    gpioModeInputPull, 1) \
+    X(arg, BUZZER,    PIN_BUZZER,    gpioModePushPull,  0)
+
+/**
+ * Enable the GPIO clock and configure all board pins, call once at boot
+ * before the drivers. Other pins on the ports are not changed.
+ */
+void board_init (void);
+
+#endif//BOARD_H_
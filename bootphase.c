@@ -0,0 +1,65 @@
+/**
+ * @brief Boot phase timestamps.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include "bootphase.h"
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+#include "em_cmu.h"
+
+#include "cycles.h"
+
+#include "loglevels.h"
+#define __MODUUL__ "boot"
+#define __LOG_LEVEL__ (LOG_LEVEL_main & BASE_LOG_LEVEL)
+#include "log.h"
+
+static const char * const m_names[BOOTPHASE_COUNT] = {
+    "main", "platform", "serial", "info", "kernel", "threads", "scheduler", "first LED"
+};
+
+static uint32_t m_marks[BOOTPHASE_COUNT];
+static uint16_t m_marked;
+
+void bootphase_mark (bootphase_t phase)
+{
+    if (phase == BOOTPHASE_MAIN)
+    {
+        cycles_init();
+    }
+    m_marks[phase] = cycles_now();
+    m_marked |= (1 << phase);
+}
+
+void bootphase_report (void)
+{
+    // Phases before PLATFORM_Init ran from the reset clock, the conversion
+    // to microseconds uses the final core clock
+    uint32_t mhz = CMU_ClockFreqGet(cmuClock_CORE) / 1000000;
+    uint32_t prev = 0;
+    uint16_t left = m_marked;
+
+    // In the order the marks were made, deferred phases come late
+    while (left != 0)
+    {
+        uint8_t next = 0;
+        uint32_t since = UINT32_MAX;
+
+        for (uint8_t p = 0; p < BOOTPHASE_COUNT; p++)
+        {
+            if ((left & (1 << p)) && (m_marks[p] - m_marks[BOOTPHASE_MAIN] <= since))
+            {
+                next = p;
+                since = m_marks[p] - m_marks[BOOTPHASE_MAIN];
+            }
+        }
+        left &= ~(1 << next);
+
+        info1("%-10s +%9"PRIu32" %9"PRIu32" cycles %6"PRIu32" us", m_names[next], since - prev, since, since / mhz);
+        prev = since;
+    }
+}
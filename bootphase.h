@@ -0,0 +1,36 @@
+/**
+ * @brief Boot phase timestamps from the cycle counter, started at the top
+ * of main(). Marks made before the kernel runs are reported afterwards.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef BOOTPHASE_H_
+#define BOOTPHASE_H_
+
+// Phases in boot order, a mark records the end of a phase
+typedef enum
+{
+    BOOTPHASE_MAIN,      // main() entered, cycle counter started
+    BOOTPHASE_PLATFORM,  // Clocks, platform and board pins
+    BOOTPHASE_SERIAL,    // Serial port and boot logger
+    BOOTPHASE_INFO,      // Banner, image CRC and header
+    BOOTPHASE_KERNEL,    // Kernel and idle initialization
+    BOOTPHASE_THREADS,   // Application threads created
+    BOOTPHASE_SCHEDULER, // First application thread running
+    BOOTPHASE_FIRST_LED, // LED pattern started
+    BOOTPHASE_COUNT
+} bootphase_t;
+
+/**
+ * Record the end of a phase, phases may be skipped or marked out of order.
+ */
+void bootphase_mark (bootphase_t phase);
+
+/**
+ * Log the marked phases in time order with the time since the previous
+ * mark and since main() was entered.
+ */
+void bootphase_report (void);
+
+#endif//BOOTPHASE_H_
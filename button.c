@@ -0,0 +1,179 @@
+/**
+ * @brief Button debouncing and press classification.
+ *
+ * The first edge disables the pin interrupt and starts the debounce timer,
+ * the edges after it are not seen and do not restart it. When the timer
+ * expires, BUTTON_DEBOUNCE_MS after the first edge, the interrupt is
+ * enabled again, the pin level is sampled once and the state machine is
+ * updated. A second timer measures the long press, repeat and double-click
+ * times from the stored press and release ticks. It is separate, so that
+ * rescheduling it cannot override a debounce started by an edge in the
+ * meantime, and a bounce does not stretch the times.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include "button.h"
+
+#include <stdbool.h>
+
+#include "cmsis_os2.h"
+#include "FreeRTOS.h"
+#include "timers.h"
+
+#include "em_gpio.h"
+
+#include "pins.h"
+#include "gpioint.h"
+#include "latency.h"
+#include "gpiotrace.h"
+
+#define BUTTON_PORT PIN_PORT(PIN_BUTTON)
+#define BUTTON_PIN  PIN_NUM(PIN_BUTTON)
+#define BUTTON_INT  4 // External interrupt number
+
+typedef enum
+{
+    BUTTON_IDLE,     // Released
+    BUTTON_PRESSED,  // Pressed, shorter than BUTTON_LONG_MS so far
+    BUTTON_HELD,     // Long press reported, repeating
+    BUTTON_RELEASED  // Released after a short press, waiting for a second one
+} button_state_t;
+
+static button_event_f m_callback;
+static osTimerId_t m_timer;
+static StaticTimer_t m_timer_cb;
+static osTimerId_t m_debounce_timer;
+static StaticTimer_t m_debounce_timer_cb;
+
+static button_state_t m_state;
+static bool m_second;        // The current press is the second of a double-click
+static uint32_t m_edge_tick; // Start of the current press or release
+static uint32_t m_deadline;  // Tick of the next timeout
+
+static uint32_t ms_to_ticks (uint32_t ms)
+{
+    return ms * osKernelGetTickFreq() / 1000;
+}
+
+static void schedule (uint32_t deadline, uint32_t now)
+{
+    int32_t wait = (int32_t)(deadline - now);
+
+    m_deadline = deadline;
+    osTimerStart(m_timer, wait > 0 ? (uint32_t)wait : 1);
+}
+
+// A stable level after debouncing
+static void button_level (bool pressed, uint32_t now)
+{
+    switch (m_state)
+    {
+        case BUTTON_IDLE:
+        case BUTTON_RELEASED:
+            if (pressed)
+            {
+                m_second = (m_state == BUTTON_RELEASED);
+                m_state = BUTTON_PRESSED;
+                m_edge_tick = now;
+                schedule(now + ms_to_ticks(BUTTON_LONG_MS), now);
+            }
+        break;
+        case BUTTON_PRESSED:
+            if (!pressed)
+            {
+                if (m_second)
+                {
+                    m_state = BUTTON_IDLE;
+                    osTimerStop(m_timer);
+                    m_callback(BUTTON_DOUBLE);
+                }
+                else
+                {
+                    m_state = BUTTON_RELEASED;
+                    m_edge_tick = now;
+                    schedule(now + ms_to_ticks(BUTTON_DOUBLE_MS), now);
+                }
+            }
+        break;
+        case BUTTON_HELD:
+            if (!pressed)
+            {
+                m_state = BUTTON_IDLE;
+                osTimerStop(m_timer);
+            }
+        break;
+    }
+}
+
+// A classification timeout
+static void button_timeout (uint32_t now)
+{
+    switch (m_state)
+    {
+        case BUTTON_PRESSED:
+            m_state = BUTTON_HELD;
+            schedule(m_deadline + ms_to_ticks(BUTTON_REPEAT_MS), now);
+            m_callback(BUTTON_LONG);
+        break;
+        case BUTTON_HELD:
+            schedule(m_deadline + ms_to_ticks(BUTTON_REPEAT_MS), now);
+            m_callback(BUTTON_REPEAT);
+        break;
+        case BUTTON_RELEASED:
+            m_state = BUTTON_IDLE;
+            latency_start(LATENCY_BUTTON_TONE);
+            m_callback(BUTTON_SHORT);
+        break;
+        default:
+        break;
+    }
+}
+
+static void button_timer_cb (void *argument)
+{
+    button_timeout(osKernelGetTickCount());
+}
+
+static void button_debounce_cb (void *argument)
+{
+    // Edges from here on start a new debounce period, a change after the
+    // sample below is not lost
+    GPIO_IntClear(1 << BUTTON_INT);
+    GPIO_IntEnable(1 << BUTTON_INT);
+    gpiotrace_in(BUTTON_PORT);
+    button_level(!pin_get(PIN_BUTTON), osKernelGetTickCount());
+}
+
+// Pin edge, called from the interrupt by the GPIO dispatcher
+static void button_edge (uint8_t intno, void * arg)
+{
+    BaseType_t woken = pdFALSE;
+
+    // Ignore edges until the debounce period is over, CMSIS timer
+    // handles are FreeRTOS timer handles
+    gpiotrace_in(BUTTON_PORT);
+    GPIO_IntDisable(1 << BUTTON_INT);
+    if (xTimerChangePeriodFromISR((TimerHandle_t)m_debounce_timer, ms_to_ticks(BUTTON_DEBOUNCE_MS), &woken) != pdPASS)
+    {
+        // Timer command queue full, nothing would enable the interrupt
+        // again. Drop this edge, the level is sampled after the next one.
+        GPIO_IntClear(1 << BUTTON_INT);
+        GPIO_IntEnable(1 << BUTTON_INT);
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+void button_init (button_event_f callback)
+{
+    m_callback = callback;
+    m_state = BUTTON_IDLE;
+    const osTimerAttr_t timer_attr = { .name = "button", .cb_mem = &m_timer_cb, .cb_size = sizeof(m_timer_cb) };
+    m_timer = osTimerNew(button_timer_cb, osTimerOnce, NULL, &timer_attr);
+    const osTimerAttr_t debounce_attr = { .name = "debounce", .cb_mem = &m_debounce_timer_cb, .cb_size = sizeof(m_debounce_timer_cb) };
+    m_debounce_timer = osTimerNew(button_debounce_cb, osTimerOnce, NULL, &debounce_attr);
+
+    // Interrupt on both edges, handled in the interrupt
+    gpioint_register(BUTTON_INT, button_edge, NULL, false);
+    GPIO_ExtIntConfig(BUTTON_PORT, BUTTON_PIN, BUTTON_INT, true, true, true);
+}
@@ -0,0 +1,57 @@
+/**
+ * @brief Debounced button on PF4 with press classification.
+ *
+ * Button edges raise an interrupt that starts a one-shot debounce timer,
+ * the button is never polled. Stable presses are classified into short
+ * press, double-click, long press and repeats while held. Events are
+ * delivered to a callback from the RTOS timer thread.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef BUTTON_H_
+#define BUTTON_H_
+
+// The level is sampled once this long after the first edge, the edges in
+// between are ignored
+#ifndef BUTTON_DEBOUNCE_MS
+#define BUTTON_DEBOUNCE_MS 20
+#endif//BUTTON_DEBOUNCE_MS
+
+// Holding longer than this is a long press
+#ifndef BUTTON_LONG_MS
+#define BUTTON_LONG_MS 1000
+#endif//BUTTON_LONG_MS
+
+// A second press must start within this time after release for a double-click
+#ifndef BUTTON_DOUBLE_MS
+#define BUTTON_DOUBLE_MS 300
+#endif//BUTTON_DOUBLE_MS
+
+// Interval of repeat events while the button is held after a long press
+#ifndef BUTTON_REPEAT_MS
+#define BUTTON_REPEAT_MS 250
+#endif//BUTTON_REPEAT_MS
+
+typedef enum
+{
+    BUTTON_SHORT,  // Pressed and released, no second press followed
+    BUTTON_DOUBLE, // Two short presses in a row
+    BUTTON_LONG,   // Held for BUTTON_LONG_MS, still held
+    BUTTON_REPEAT  // Still held, every BUTTON_REPEAT_MS after BUTTON_LONG
+} button_event_t;
+
+/**
+ * Button event callback, called from the RTOS timer thread, must not block.
+ */
+typedef void (*button_event_f)(button_event_t event);
+
+/**
+ * Configure the button edge interrupt. The pin must be configured as an
+ * input with pull-up by board_init() and gpioint_init() called.
+ *
+ * @param callback Receives the button events.
+ */
+void button_init (button_event_f callback);
+
+#endif//BUTTON_H_
@@ -0,0 +1,126 @@
+/**
+ * @brief CPU usage accounting with FreeRTOS run-time statistics.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include "cpuload.h"
+
+#include <stdbool.h>
+#include <inttypes.h>
+
+#include "cmsis_os2.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "em_cmu.h"
+
+#include "cycles.h"
+
+#include "loglevels.h"
+#define __MODUUL__ "load"
+#define __LOG_LEVEL__ (LOG_LEVEL_cpuload & BASE_LOG_LEVEL)
+#include "log.h"
+
+// Updated by the context switch hooks
+static uint32_t m_switches;
+static uint32_t m_switch_in;     // Cycle count when the current thread was switched in
+static uint32_t m_max_run;       // Longest run without a switch, cycles
+static TaskHandle_t m_max_run_task;
+
+// Used by cpuload_report only
+static TaskStatus_t m_status[CPULOAD_MAX_THREADS];
+static TaskHandle_t m_prev_task[CPULOAD_MAX_THREADS];
+static uint32_t m_prev_counter[CPULOAD_MAX_THREADS];
+static uint32_t m_prev_tick;
+
+void cpuload_timer_init (void)
+{
+    cycles_init();
+}
+
+uint32_t cpuload_timer_get (void)
+{
+    return cycles_now();
+}
+
+void cpuload_switched_out (void)
+{
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+
+    if (task != xTaskGetIdleTaskHandle())
+    {
+        uint32_t run = cycles_now() - m_switch_in;
+        if (run > m_max_run)
+        {
+            m_max_run = run;
+            m_max_run_task = task;
+        }
+    }
+}
+
+void cpuload_switched_in (void)
+{
+    m_switch_in = cycles_now();
+    m_switches++;
+}
+
+static uint32_t previous_counter (TaskHandle_t task)
+{
+    for (uint32_t i = 0; i < CPULOAD_MAX_THREADS; i++)
+    {
+        if (m_prev_task[i] == task)
+        {
+            return m_prev_counter[i];
+        }
+    }
+    return 0;
+}
+
+void cpuload_report (void)
+{
+    uint32_t now = osKernelGetTickCount();
+    uint32_t total;
+
+    // Snapshot and reset the hook counters
+    osKernelLock();
+    UBaseType_t count = uxTaskGetSystemState(m_status, CPULOAD_MAX_THREADS, &total);
+    uint32_t switches = m_switches;
+    uint32_t max_run = m_max_run;
+    TaskHandle_t max_run_task = m_max_run_task;
+    m_switches = 0;
+    m_max_run = 0;
+    m_max_run_task = NULL;
+    osKernelUnlock();
+
+    uint32_t ticks = now - m_prev_tick;
+    uint64_t interval = (uint64_t)ticks * CMU_ClockFreqGet(cmuClock_CORE) / osKernelGetTickFreq();
+    uint32_t busy = 0;
+    bool first = (m_prev_tick == 0);
+
+    if ((interval > 0) && !first)
+    {
+        for (UBaseType_t i = 0; i < count; i++)
+        {
+            if (m_status[i].xHandle == xTaskGetIdleTaskHandle())
+            {
+                continue;
+            }
+            uint32_t cycles = m_status[i].ulRunTimeCounter - previous_counter(m_status[i].xHandle);
+            uint32_t permille = (uint32_t)(((uint64_t)cycles * 1000) / interval);
+            busy += permille;
+            info1("%-12s %3"PRIu32".%"PRIu32"%%", m_status[i].pcTaskName, permille / 10, permille % 10);
+        }
+        uint32_t idle = (busy < 1000) ? 1000 - busy : 0;
+        info1("idle %"PRIu32".%"PRIu32"%%, %"PRIu32" switches, longest run %"PRIu32" cycles (%s)",
+              idle / 10, idle % 10, switches, max_run,
+              max_run_task != NULL ? pcTaskGetName(max_run_task) : "-");
+    }
+
+    for (UBaseType_t i = 0; i < CPULOAD_MAX_THREADS; i++)
+    {
+        m_prev_task[i] = (i < count) ? m_status[i].xHandle : NULL;
+        m_prev_counter[i] = (i < count) ? m_status[i].ulRunTimeCounter : 0;
+    }
+    m_prev_tick = (now != 0) ? now : 1;
+}
@@ -0,0 +1,33 @@
+/**
+ * @brief Per-thread CPU usage accounting from the FreeRTOS run-time
+ * statistics, counted with the DWT cycle counter.
+ *
+ * The context switch hooks only store a few counters. All division and
+ * formatting happens in cpuload_report(), called from a low priority
+ * thread.
+ *
+ * The cycle counter stops while the core sleeps, so loads are computed
+ * against the elapsed kernel ticks and idle is the remainder, which
+ * includes the time spent sleeping.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef CPULOAD_H_
+#define CPULOAD_H_
+
+// Number of threads included in the report
+#ifndef CPULOAD_MAX_THREADS
+#define CPULOAD_MAX_THREADS 12
+#endif//CPULOAD_MAX_THREADS
+
+/**
+ * Log the CPU use of each thread, the idle share, the number of context
+ * switches and the longest time a thread other than idle ran without being
+ * switched out, all since the previous report. The longest run includes
+ * the time the scheduler was locked or interrupts were masked, so it
+ * bounds the longest non-preemptible section.
+ */
+void cpuload_report (void);
+
+#endif//CPULOAD_H_
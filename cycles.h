@@ -0,0 +1,31 @@
+/**
+ * @brief Cycle counting with the DWT cycle counter of the Cortex-M4.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef CYCLES_H_
+#define CYCLES_H_
+
+#include <stdint.h>
+
+#include "em_device.h"
+
+/**
+ * Start the cycle counter, safe to call more than once.
+ */
+static inline void cycles_init (void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNT_ENA_Msk;
+}
+
+/**
+ * @return Current cycle count, wraps around every 2^32 cycles.
+ */
+static inline uint32_t cycles_now (void)
+{
+    return DWT->CYCCNT;
+}
+
+#endif//CYCLES_H_
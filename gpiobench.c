@@ -0,0 +1,128 @@
+/**
+ * @brief GPIO access primitive benchmark.
+ *
+ * Every primitive is wrapped in a loop function per optimization level
+ * with the optimize attribute, from one list of statements.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include "gpiobench.h"
+
+#include <inttypes.h>
+
+#include "em_bus.h"
+#include "em_core.h"
+#include "em_gpio.h"
+
+#include "pins.h"
+#include "cycles.h"
+
+#include "loglevels.h"
+#define __MODUUL__ "bench"
+#define __LOG_LEVEL__ (LOG_LEVEL_gpiobench & BASE_LOG_LEVEL)
+#include "log.h"
+
+#define GPIOBENCH_PORT PIN_PORT(PIN_LED_GREEN)
+#define GPIOBENCH_PIN  PIN_NUM(PIN_LED_GREEN)
+
+static volatile uint32_t m_sink;
+
+// id, label, statement
+#define GPIOBENCH_PRIMITIVES(X) \
+    X(loop,     "loop",                 __asm__ volatile ("")) \
+    X(toggle,   "GPIO_PinOutToggle",    GPIO_PinOutToggle(GPIOBENCH_PORT, GPIOBENCH_PIN)) \
+    X(set,      "GPIO_PinOutSet",       GPIO_PinOutSet(GPIOBENCH_PORT, GPIOBENCH_PIN)) \
+    X(in,       "GPIO_PinInGet",        m_sink = GPIO_PinInGet(GPIOBENCH_PORT, GPIOBENCH_PIN)) \
+    X(setval,   "GPIO_PortOutSetVal",   GPIO_PortOutSetVal(GPIOBENCH_PORT, 1 << GPIOBENCH_PIN, 1 << GPIOBENCH_PIN)) \
+    X(douttgl,  "DOUTTGL write",        GPIO->P[GPIOBENCH_PORT].DOUTTGL = 1 << GPIOBENCH_PIN) \
+    X(bitband,  "bit-band write",       BUS_RegBitWrite(&GPIO->P[GPIOBENCH_PORT].DOUT, GPIOBENCH_PIN, 1)) \
+    X(bitset,   "BITSET alias write",   BUS_RegMaskedSet(&GPIO->P[GPIOBENCH_PORT].DOUT, 1 << GPIOBENCH_PIN)) \
+    X(rmw,      "DOUT read-modify-write", GPIO->P[GPIOBENCH_PORT].DOUT |= 1 << GPIOBENCH_PIN) \
+    X(pinset,   "pin_set",              pin_set(PIN_LED_GREEN)) \
+    X(pinclear, "pin_clear",            pin_clear(PIN_LED_GREEN)) \
+    X(pintgl,   "pin_toggle",           pin_toggle(PIN_LED_GREEN)) \
+    X(pinget,   "pin_get",              m_sink = pin_get(PIN_LED_GREEN))
+
+#define GPIOBENCH_FUNC(id, label, stmt, level) \
+    __attribute__((optimize(#level), noinline)) static uint32_t bench_##id##_##level (void) \
+    { \
+        uint32_t start = cycles_now(); \
+        for (uint32_t i = 0; i < GPIOBENCH_ITERATIONS; i++) \
+        { \
+            stmt; \
+        } \
+        return cycles_now() - start; \
+    }
+
+#define GPIOBENCH_FUNCS(id, label, stmt) \
+    GPIOBENCH_FUNC(id, label, stmt, O0) \
+    GPIOBENCH_FUNC(id, label, stmt, Os) \
+    GPIOBENCH_FUNC(id, label, stmt, O2)
+
+GPIOBENCH_PRIMITIVES(GPIOBENCH_FUNCS)
+
+#define GPIOBENCH_LEVELS 3
+
+typedef struct
+{
+    const char * label;
+    uint32_t (*run[GPIOBENCH_LEVELS])(void);
+} gpiobench_t;
+
+#define GPIOBENCH_ENTRY(id, label, stmt) { label, { bench_##id##_O0, bench_##id##_Os, bench_##id##_O2 } },
+
+static const gpiobench_t m_benches[] = {
+    GPIOBENCH_PRIMITIVES(GPIOBENCH_ENTRY)
+};
+
+#define GPIOBENCH_COUNT (sizeof(m_benches) / sizeof(m_benches[0]))
+
+// Cycles of one run, fastest of a few to skip cache and flash warm-up
+static uint32_t measure (uint32_t (*run)(void))
+{
+    uint32_t best = UINT32_MAX;
+
+    for (uint8_t k = 0; k < 3; k++)
+    {
+        CORE_DECLARE_IRQ_STATE;
+        CORE_ENTER_CRITICAL();
+        uint32_t cycles = run();
+        CORE_EXIT_CRITICAL();
+        if (cycles < best)
+        {
+            best = cycles;
+        }
+    }
+    return best;
+}
+
+void gpiobench_run (void)
+{
+    uint32_t loop[GPIOBENCH_LEVELS];
+
+    cycles_init();
+
+    info1("cycles per call x10, %u calls: O0 Os O2", GPIOBENCH_ITERATIONS);
+    for (uint8_t b = 0; b < GPIOBENCH_COUNT; b++)
+    {
+        uint32_t tenths[GPIOBENCH_LEVELS];
+
+        for (uint8_t l = 0; l < GPIOBENCH_LEVELS; l++)
+        {
+            uint32_t cycles = measure(m_benches[b].run[l]);
+            if (b == 0)
+            {
+                loop[l] = cycles; // The empty loop is listed as is
+                tenths[l] = cycles * 10 / GPIOBENCH_ITERATIONS;
+            }
+            else
+            {
+                tenths[l] = (cycles > loop[l] ? cycles - loop[l] : 0) * 10 / GPIOBENCH_ITERATIONS;
+            }
+        }
+        info1("%-24s %6"PRIu32" %6"PRIu32" %6"PRIu32, m_benches[b].label, tenths[0], tenths[1], tenths[2]);
+    }
+
+    GPIO_PinOutClear(GPIOBENCH_PORT, GPIOBENCH_PIN);
+}
@@ -0,0 +1,27 @@
+/**
+ * @brief Cycle cost of GPIO access primitives, built with GPIOBENCH=1.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef GPIOBENCH_H_
+#define GPIOBENCH_H_
+
+// Calls per measurement
+#ifndef GPIOBENCH_ITERATIONS
+#define GPIOBENCH_ITERATIONS 1000
+#endif//GPIOBENCH_ITERATIONS
+
+/**
+ * Measure each primitive in loops compiled at -O0, -Os and -O2 and log a
+ * table of cycles per call with the loop overhead subtracted. Toggles the
+ * green LED pin configured by board_init(), interrupts are disabled during
+ * each measurement.
+ *
+ * The optimization level applies to the loop and the inline register
+ * accesses; emlib functions that are not inlined keep the level of the
+ * build.
+ */
+void gpiobench_run (void);
+
+#endif//GPIOBENCH_H_
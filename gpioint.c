@@ -0,0 +1,119 @@
+/**
+ * @brief GPIO external interrupt dispatcher.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include "gpioint.h"
+
+#include <stddef.h>
+
+#include "em_gpio.h"
+
+#define GPIOINT_EVEN_MASK 0x5555
+#define GPIOINT_ODD_MASK  0xAAAA
+#define GPIOINT_FLAG      1 // Thread flag for pending deferred callbacks
+
+typedef struct
+{
+    gpioint_callback_f callback;
+    void * arg;
+} gpioint_entry_t;
+
+static gpioint_entry_t m_entries[GPIOINT_COUNT];
+static volatile uint32_t m_deferred; // Interrupts with deferred callbacks
+static volatile uint32_t m_pending;  // Deferred interrupts waiting for the thread
+static osThreadId_t m_thread;
+
+static void call (uint32_t flags)
+{
+    while (flags != 0)
+    {
+        uint8_t intno = __builtin_ctz(flags);
+        const gpioint_entry_t * e = &m_entries[intno];
+
+        flags &= flags - 1;
+        if (e->callback != NULL)
+        {
+            e->callback(intno, e->arg);
+        }
+    }
+}
+
+static void gpioint_loop (void * argument)
+{
+    for (;;)
+    {
+        osThreadFlagsWait(GPIOINT_FLAG, osFlagsWaitAny, osWaitForever);
+        call(__atomic_exchange_n(&m_pending, 0, __ATOMIC_RELAXED));
+    }
+}
+
+void gpioint_dispatch (uint32_t flags)
+{
+    uint32_t deferred = flags & m_deferred;
+
+    call(flags & ~deferred);
+    if (deferred != 0)
+    {
+        __atomic_fetch_or(&m_pending, deferred, __ATOMIC_RELAXED);
+        osThreadFlagsSet(m_thread, GPIOINT_FLAG);
+    }
+}
+
+void GPIO_EVEN_IRQHandler (void)
+{
+    uint32_t flags = GPIO_IntGetEnabled() & GPIOINT_EVEN_MASK;
+
+    GPIO_IntClear(flags);
+    gpioint_dispatch(flags);
+}
+
+void GPIO_ODD_IRQHandler (void)
+{
+    uint32_t flags = GPIO_IntGetEnabled() & GPIOINT_ODD_MASK;
+
+    GPIO_IntClear(flags);
+    gpioint_dispatch(flags);
+}
+
+void gpioint_init (const osThreadAttr_t * attr)
+{
+    if (attr != NULL)
+    {
+        m_thread = osThreadNew(gpioint_loop, NULL, attr);
+    }
+
+    const IRQn_Type irqs[] = { GPIO_EVEN_IRQn, GPIO_ODD_IRQn };
+    for (uint8_t i = 0; i < sizeof(irqs) / sizeof(irqs[0]); i++)
+    {
+        NVIC_SetPriority(irqs[i], (1 << __NVIC_PRIO_BITS) - 1);
+        NVIC_ClearPendingIRQ(irqs[i]);
+        NVIC_EnableIRQ(irqs[i]);
+    }
+}
+
+bool gpioint_register (uint8_t intno, gpioint_callback_f callback, void * arg, bool deferred)
+{
+    if ((intno >= GPIOINT_COUNT) || (deferred && (m_thread == NULL)))
+    {
+        return false;
+    }
+
+    // The handlers must not see a callback with the argument of another
+    NVIC_DisableIRQ(GPIO_EVEN_IRQn);
+    NVIC_DisableIRQ(GPIO_ODD_IRQn);
+    m_entries[intno].callback = callback;
+    m_entries[intno].arg = arg;
+    if (deferred)
+    {
+        __atomic_fetch_or(&m_deferred, 1UL << intno, __ATOMIC_RELAXED);
+    }
+    else
+    {
+        __atomic_fetch_and(&m_deferred, ~(1UL << intno), __ATOMIC_RELAXED);
+    }
+    NVIC_EnableIRQ(GPIO_EVEN_IRQn);
+    NVIC_EnableIRQ(GPIO_ODD_IRQn);
+    return true;
+}
@@ -0,0 +1,60 @@
+/**
+ * @brief GPIO external interrupt dispatcher with per-interrupt callbacks.
+ *
+ * The dispatcher owns the GPIO_EVEN and GPIO_ODD interrupt handlers. Each
+ * pending interrupt number is found with a count-trailing-zeros loop and
+ * its callback looked up from a table, so the cost depends only on the
+ * number of interrupts pending, not on the number registered. A callback
+ * runs in the interrupt handler or is deferred to the dispatcher thread.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef GPIOINT_H_
+#define GPIOINT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "cmsis_os2.h"
+
+#define GPIOINT_COUNT 16 // External interrupt numbers
+
+/**
+ * Callback for an external interrupt, in interrupt context it may only
+ * use ISR-safe RTOS calls.
+ *
+ * @param intno External interrupt number.
+ * @param arg   Argument given at registration.
+ */
+typedef void (*gpioint_callback_f) (uint8_t intno, void * arg);
+
+/**
+ * Set up the interrupt lines at the lowest priority, so that callbacks
+ * can use RTOS calls, and create the thread for deferred callbacks.
+ *
+ * @param attr Thread attributes including memory, NULL for no thread and
+ *             interrupt context callbacks only.
+ */
+void gpioint_init (const osThreadAttr_t * attr);
+
+/**
+ * Register the callback of an external interrupt, replaces an earlier one.
+ * The pin is configured and its interrupt enabled by the caller, with
+ * GPIO_ExtIntConfig().
+ *
+ * @param intno    External interrupt number.
+ * @param callback Callback, NULL to remove.
+ * @param arg      Passed to the callback.
+ * @param deferred Call from the dispatcher thread instead of the interrupt.
+ * @return false if the number is invalid or deferral is not available.
+ */
+bool gpioint_register (uint8_t intno, gpioint_callback_f callback, void * arg, bool deferred);
+
+/**
+ * Dispatch interrupt flags that have been read and cleared, called by the
+ * interrupt handlers.
+ */
+void gpioint_dispatch (uint32_t flags);
+
+#endif//GPIOINT_H_
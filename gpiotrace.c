@@ -0,0 +1,144 @@
+/**
+ * @brief GPIO transition recorder, VCD output through the logger, so it
+ * stays readable with the log ring and with binary logging.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include "gpiotrace.h"
+
+#include <inttypes.h>
+
+#include "cmsis_os2.h"
+
+#include "tone.h"
+#ifdef LOGGER_RING
+#include "logger_ring.h"
+#endif//LOGGER_RING
+
+#include "loglevels.h"
+#define __MODUUL__ "gtrace"
+#define __LOG_LEVEL__ (LOG_LEVEL_gpiotrace & BASE_LOG_LEVEL)
+#include "log.h"
+
+typedef struct
+{
+    const char * name;
+    char id;        // VCD identifier
+    uint8_t source;
+    uint8_t pin;    // Bit in the value, unused for the tone
+} gpiotrace_signal_t;
+
+static const gpiotrace_signal_t m_signals[] = {
+    { "led_red",   'r', GPIOTRACE_DOUT(gpioPortB), 11 },
+    { "led_green", 'g', GPIOTRACE_DOUT(gpioPortB), 12 },
+    { "led_blue",  'b', GPIOTRACE_DOUT(gpioPortA), 5 },
+    { "button",    'k', GPIOTRACE_DIN(gpioPortF),  4 },
+    { "buzzer_hz", 't', GPIOTRACE_TONE,            0 },
+};
+
+#define GPIOTRACE_SIGNALS (sizeof(m_signals) / sizeof(m_signals[0]))
+#define GPIOTRACE_UNKNOWN 0xFFFFFFFF
+
+gpiotrace_record_t gpiotrace_buffer[GPIOTRACE_LEN];
+uint32_t gpiotrace_head;
+
+// Keep half of the log ring free, the drain thread runs while waiting
+static void wait_log (void)
+{
+#ifdef LOGGER_RING
+    while (logger_ring_pending() > LOGGER_RING_SLOTS / 2)
+    {
+        osDelay(1);
+    }
+#endif//LOGGER_RING
+}
+
+static uint32_t tone_hz (const gpiotrace_record_t * rec)
+{
+    if (rec->value == 0)
+    {
+        return 0;
+    }
+    return (TONE_TIMER_HZ >> rec->extra) / ((uint32_t)rec->value + 1);
+}
+
+void gpiotrace_dump (void)
+{
+    static uint32_t value[GPIOTRACE_SIGNALS];
+    uint32_t hz = GPIOTRACE_TIME_HZ;
+    uint32_t head = __atomic_load_n(&gpiotrace_head, __ATOMIC_RELAXED);
+    uint32_t first = (head > GPIOTRACE_LEN) ? head - GPIOTRACE_LEN : 0;
+    uint64_t elapsed = 0; // Since the first record, clock counts
+    uint32_t last = 0;
+    uint32_t printed = UINT32_MAX;
+
+    wait_log();
+    info1("$comment gpiotrace %"PRIu32" records $end", head - first);
+    info1("$timescale 1 us $end");
+    info1("$scope module esw_gpio $end");
+    for (uint8_t s = 0; s < GPIOTRACE_SIGNALS; s++)
+    {
+        wait_log();
+        if (m_signals[s].source == GPIOTRACE_TONE)
+        {
+            info1("$var real 32 %c %s $end", m_signals[s].id, m_signals[s].name);
+        }
+        else
+        {
+            info1("$var wire 1 %c %s $end", m_signals[s].id, m_signals[s].name);
+        }
+        value[s] = GPIOTRACE_UNKNOWN;
+    }
+    wait_log();
+    info1("$upscope $end");
+    info1("$enddefinitions $end");
+
+    for (uint32_t i = first; i != head; i++)
+    {
+        // Records are overwritten while printing, the clock wraps around
+        // but the difference between consecutive ones does not
+        if (__atomic_load_n(&gpiotrace_head, __ATOMIC_RELAXED) - i > GPIOTRACE_LEN)
+        {
+            continue;
+        }
+        const gpiotrace_record_t * rec = &gpiotrace_buffer[i & (GPIOTRACE_LEN - 1)];
+        if (i != first)
+        {
+            elapsed += rec->time - last;
+        }
+        last = rec->time;
+
+        for (uint8_t s = 0; s < GPIOTRACE_SIGNALS; s++)
+        {
+            if (rec->source != m_signals[s].source)
+            {
+                continue;
+            }
+            uint32_t v = (rec->source == GPIOTRACE_TONE) ? tone_hz(rec) : (rec->value >> m_signals[s].pin) & 1;
+            if (v == value[s])
+            {
+                continue;
+            }
+            value[s] = v;
+
+            // 32-bit microseconds, printf may not support 64-bit integers
+            uint32_t us = (uint32_t)(elapsed * 1000000 / hz);
+            wait_log();
+            if (us != printed)
+            {
+                info1("#%"PRIu32, us);
+                printed = us;
+            }
+            if (rec->source == GPIOTRACE_TONE)
+            {
+                info1("r%"PRIu32" %c", v, m_signals[s].id);
+            }
+            else
+            {
+                info1("%"PRIu32"%c", v, m_signals[s].id);
+            }
+        }
+    }
+    info1("$comment end $end");
+}
@@ -0,0 +1,98 @@
+/**
+ * @brief GPIO transition recorder with Value Change Dump output.
+ *
+ * Drivers record the port output register after every write, the button
+ * its input register and the tone engine its timer prescaler and TOP. A
+ * record is a timestamp, one 16-bit value and one 8-bit extra in a ring
+ * buffer, the oldest records are overwritten. Recording does not divide,
+ * gpiotrace_dump() converts the values and logs the buffer as a VCD file
+ * for GTKWave. Without GPIOTRACE all calls compile to nothing.
+ *
+ * Timestamps come from the cycle counter, or from the RTCC with tickless
+ * idle since the core clock stops in sleep. GPIOTRACE_TIME can be
+ * redefined together with GPIOTRACE_TIME_HZ to use another clock.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef GPIOTRACE_H_
+#define GPIOTRACE_H_
+
+#include <stdint.h>
+
+#ifdef GPIOTRACE
+
+#include "em_gpio.h"
+
+// Number of records, must be a power of 2
+#ifndef GPIOTRACE_LEN
+#define GPIOTRACE_LEN 256
+#endif//GPIOTRACE_LEN
+
+#ifndef GPIOTRACE_TIME
+#if configUSE_TICKLESS_IDLE == 2
+#include "em_rtcc.h"
+#define GPIOTRACE_TIME()   RTCC_CounterGet()
+#define GPIOTRACE_TIME_HZ  32768UL
+#else
+#include "em_cmu.h"
+#include "cycles.h"
+#define GPIOTRACE_TIME()   cycles_now()
+#define GPIOTRACE_TIME_HZ  CMU_ClockFreqGet(cmuClock_CORE)
+#endif//configUSE_TICKLESS_IDLE
+#endif//GPIOTRACE_TIME
+
+// Record sources
+#define GPIOTRACE_DOUT(port) (port)          // Port output register
+#define GPIOTRACE_DIN(port)  (0x10 | (port)) // Port input register
+#define GPIOTRACE_TONE       0x20            // Buzzer timer TOP, 0 when silent
+
+typedef struct
+{
+    uint32_t time;
+    uint16_t value;
+    uint8_t source;
+    uint8_t extra;  // Timer prescaler of a tone record
+} gpiotrace_record_t;
+
+extern gpiotrace_record_t gpiotrace_buffer[GPIOTRACE_LEN];
+extern uint32_t gpiotrace_head;
+
+/**
+ * Record a value, safe in interrupts.
+ */
+static inline void gpiotrace_record (uint8_t source, uint16_t value, uint8_t extra)
+{
+    uint32_t i = __atomic_fetch_add(&gpiotrace_head, 1, __ATOMIC_RELAXED) & (GPIOTRACE_LEN - 1);
+    gpiotrace_buffer[i].time = GPIOTRACE_TIME();
+    gpiotrace_buffer[i].value = value;
+    gpiotrace_buffer[i].source = source;
+    gpiotrace_buffer[i].extra = extra;
+}
+
+// Record the output state of a port after writing it
+#define gpiotrace_out(port) gpiotrace_record(GPIOTRACE_DOUT(port), (uint16_t)GPIO->P[port].DOUT, 0)
+
+// Record the input state of a port
+#define gpiotrace_in(port) gpiotrace_record(GPIOTRACE_DIN(port), (uint16_t)GPIO->P[port].DIN, 0)
+
+// Record the buzzer timer setting as in tone_note_t, a zero top is silence
+#define gpiotrace_tone(presc, top) gpiotrace_record(GPIOTRACE_TONE, (uint16_t)(top), (uint8_t)(presc))
+
+/**
+ * Log the recorded transitions of the board pins as a VCD file, one line
+ * per message between "$comment gpiotrace" and "$comment end" lines. With
+ * the log ring the dump waits for the drain thread instead of dropping.
+ */
+void gpiotrace_dump (void);
+
+#else
+
+#define gpiotrace_out(port)
+#define gpiotrace_in(port)
+#define gpiotrace_tone(presc, top)
+#define gpiotrace_dump()
+
+#endif//GPIOTRACE
+
+#endif//GPIOTRACE_H_
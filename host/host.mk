@@ -0,0 +1,133 @@
+# Host simulation build, see host/sim.h
+#
+#   make host       build the application and the module tests, run the tests,
+#                   the benchmarks and the application regression test, twice
+#                   to compare, and check the pin accessors are inlined in
+#                   gpiobench.o
+#   make host-app   build the application, run it with build/host/esw-gpio
+#   make host-tools build the tools in tools/, also used by the firmware build
+#
+# The application sources from SOURCES are compiled with gcc against the
+# stand-in headers in host/include, SDK and zoo sources are left out. The
+# tests link every module except main.c with binlog, latency tracing and
+# the GPIO trace enabled. The benchmarks in host/test/bench_*.c are built
+# the same way, they check their results and print the measurements.
+
+# Keep the firmware as the default goal
+HOST_DEFAULT_GOAL       := $(.DEFAULT_GOAL)
+
+HOST_CC                 ?= gcc
+HOST_NM                 ?= nm
+HOST_BUILD_DIR          ?= $(BUILD_BASE_DIR)/host
+
+# The project directory comes first for the FreeRTOSConfig.h include_next
+HOST_INCLUDES           := -I. -Ihost -Ihost/include
+HOST_CFLAGS             := -std=gnu99 -g -O1 -Wall -Wno-unused-function -pthread
+HOST_LDFLAGS            := -no-pie -pthread
+
+HOST_DEFINES            := $(filter-out -DVTOR_START_LOCATION=% -DconfigUSE_TICKLESS_IDLE=% -D__START=% -D__STARTUP_CLEAR_BSS -D_RTE_=%,$(filter -D%,$(CFLAGS)))
+HOST_DEFINES            += -DconfigUSE_TICKLESS_IDLE=0 '-DVTOR_START_LOCATION=((uintptr_t)sim_image)'
+HOST_DEFINES            += -DVERSION_MAJOR=$(VERSION_MAJOR) -DVERSION_MINOR=$(VERSION_MINOR) -DVERSION_PATCH=$(VERSION_PATCH)
+HOST_DEFINES            += '-DVERSION_STR=$(VERSION_STR)'
+# Allocated section, the format strings are read in place on the host
+HOST_DEFINES            += '-DBINLOG_SECTION="binlog_fmt"'
+
+# The header data comes from host/sim_platform.c instead of header.bin
+HOST_SIM_SOURCES        := $(wildcard host/sim_*.c)
+HOST_APP_SOURCES        := $(HOST_SIM_SOURCES) $(filter-out /% appheader_data.c,$(SOURCES))
+HOST_MODULE_SOURCES     := $(HOST_SIM_SOURCES) $(filter-out main.c appheader_data.c,$(wildcard *.c))
+HOST_TESTS              := $(basename $(notdir $(wildcard host/test/test_*.c)))
+HOST_BENCHES            := $(basename $(notdir $(wildcard host/test/bench_*.c)))
+
+HOST_APP_OBJECTS        := $(patsubst %.c,$(HOST_BUILD_DIR)/app/%.o,$(HOST_APP_SOURCES))
+HOST_MODULE_OBJECTS     := $(patsubst %.c,$(HOST_BUILD_DIR)/test/%.o,$(HOST_MODULE_SOURCES))
+HOST_TEST_BINARIES      := $(addprefix $(HOST_BUILD_DIR)/,$(HOST_TESTS))
+HOST_BENCH_BINARIES     := $(addprefix $(HOST_BUILD_DIR)/,$(HOST_BENCHES))
+
+# Tools from tools/ with the firmware modules they use, sections that
+# need the firmware symbols are left out by the linker
+HOST_TOOL_CFLAGS        := $(HOST_CFLAGS) -ffunction-sections -fdata-sections
+HOST_TOOL_LDFLAGS       := $(HOST_LDFLAGS) -Wl,--gc-sections
+HOST_TOOLS              := $(HOST_BUILD_DIR)/appheader_check
+
+# The application with main() renamed, run by host/test/app_test.c
+HOST_APP_TEST_OBJECTS   := $(filter-out $(HOST_BUILD_DIR)/app/main.o,$(HOST_APP_OBJECTS))
+HOST_APP_TEST_OBJECTS   += $(HOST_BUILD_DIR)/app/app_main.o $(HOST_BUILD_DIR)/app/host/test/app_test.o
+
+host: host-app host-tools $(HOST_TEST_BINARIES) $(HOST_BENCH_BINARIES) $(HOST_BUILD_DIR)/app_test $(HOST_BUILD_DIR)/test/gpiobench.o
+	@set -e; for t in $(HOST_TEST_BINARIES) $(HOST_BENCH_BINARIES); do echo "Running [$$t]"; $$t; done
+	@echo "Checking the pin accessors are inlined [$(HOST_BUILD_DIR)/test/gpiobench.o]"
+	@$(call gpiobench_inline_check,$(HOST_NM),$(HOST_BUILD_DIR)/test/gpiobench.o)
+	@echo "Running [$(HOST_BUILD_DIR)/app_test] twice"
+	@$(HOST_BUILD_DIR)/app_test > $(HOST_BUILD_DIR)/app_test.1.log
+	@$(HOST_BUILD_DIR)/app_test > $(HOST_BUILD_DIR)/app_test.2.log
+	@tail -n 1 $(HOST_BUILD_DIR)/app_test.1.log
+	@cmp $(HOST_BUILD_DIR)/app_test.1.log $(HOST_BUILD_DIR)/app_test.2.log
+
+host-app: $(HOST_BUILD_DIR)/$(PROJECT_NAME)
+
+host-tools: $(HOST_TOOLS)
+
+$(HOST_BUILD_DIR)/appheader_check: $(HOST_BUILD_DIR)/tool/tools/appheader_check.o $(HOST_BUILD_DIR)/tool/appheader.o $(HOST_BUILD_DIR)/tool/imagecrc.o
+	$(HOST_CC) $(HOST_TOOL_LDFLAGS) $^ -o $@
+
+$(HOST_BUILD_DIR)/$(PROJECT_NAME): $(HOST_APP_OBJECTS)
+	$(HOST_CC) $(HOST_LDFLAGS) $^ -o $@
+
+$(HOST_BUILD_DIR)/app_test: $(HOST_APP_TEST_OBJECTS)
+	$(HOST_CC) $(HOST_LDFLAGS) $^ -o $@
+
+$(HOST_BUILD_DIR)/app/app_main.o: main.c Makefile host/host.mk
+	@mkdir -p $(dir $@)
+	$(HOST_CC) $(HOST_CFLAGS) $(HOST_DEFINES) -Dmain=app_main $(HOST_INCLUDES) -MMD -c $< -o $@
+
+$(HOST_BUILD_DIR)/app/%.o: %.c Makefile host/host.mk
+	@mkdir -p $(dir $@)
+	$(HOST_CC) $(HOST_CFLAGS) $(HOST_DEFINES) $(HOST_INCLUDES) -MMD -c $< -o $@
+
+$(HOST_BUILD_DIR)/test/%.o: %.c Makefile host/host.mk
+	@mkdir -p $(dir $@)
+	$(HOST_CC) $(HOST_CFLAGS) $(HOST_DEFINES) -DLOGGER_BINLOG -DLATENCY_TRACE -DGPIOTRACE $(HOST_INCLUDES) -MMD -c $< -o $@
+
+$(HOST_BUILD_DIR)/tool/%.o: %.c Makefile host/host.mk
+	@mkdir -p $(dir $@)
+	$(HOST_CC) $(HOST_TOOL_CFLAGS) $(HOST_DEFINES) $(HOST_INCLUDES) -MMD -c $< -o $@
+
+# Tools run from their tests with main() renamed
+$(HOST_BUILD_DIR)/test/tools/%_main.o: tools/%.c Makefile host/host.mk
+	@mkdir -p $(dir $@)
+	$(HOST_CC) $(HOST_CFLAGS) $(HOST_DEFINES) -Dmain=$*_main $(HOST_INCLUDES) -MMD -c $< -o $@
+
+$(HOST_BUILD_DIR)/test_appheader: $(HOST_BUILD_DIR)/test/tools/appheader_check_main.o
+
+# idle.c with tickless idle, linked only with the SysTick, RTCC and kernel
+# models of its test
+$(HOST_BUILD_DIR)/tickless/idle.o: idle.c Makefile host/host.mk
+	@mkdir -p $(dir $@)
+	$(HOST_CC) $(HOST_CFLAGS) $(filter-out -DconfigUSE_TICKLESS_IDLE=%,$(HOST_DEFINES)) -DconfigUSE_TICKLESS_IDLE=2 $(HOST_INCLUDES) -MMD -c $< -o $@
+
+$(HOST_BUILD_DIR)/test_idle: $(HOST_BUILD_DIR)/test/host/test/test_idle.o $(HOST_BUILD_DIR)/tickless/idle.o
+	$(HOST_CC) $(HOST_LDFLAGS) $^ -o $@
+
+# leds.c with software PWM for all LEDs, in place of the test module
+$(HOST_BUILD_DIR)/softpwm/leds.o: leds.c Makefile host/host.mk
+	@mkdir -p $(dir $@)
+	$(HOST_CC) $(HOST_CFLAGS) $(HOST_DEFINES) -DLOGGER_BINLOG -DLATENCY_TRACE -DGPIOTRACE -DLEDS_SOFT_PWM=1 $(HOST_INCLUDES) -MMD -c $< -o $@
+
+$(HOST_BUILD_DIR)/test_leds_softpwm: $(HOST_BUILD_DIR)/test/host/test/test_leds_softpwm.o $(HOST_BUILD_DIR)/softpwm/leds.o $(filter-out $(HOST_BUILD_DIR)/test/leds.o,$(HOST_MODULE_OBJECTS))
+	$(HOST_CC) $(HOST_LDFLAGS) $^ -o $@
+
+# Left out above, it would be deleted as an intermediate of the tests
+.SECONDARY: $(HOST_BUILD_DIR)/test/leds.o
+
+$(HOST_BUILD_DIR)/test_%: $(HOST_BUILD_DIR)/test/host/test/test_%.o $(HOST_MODULE_OBJECTS)
+	$(HOST_CC) $(HOST_LDFLAGS) $^ -o $@
+
+$(HOST_BUILD_DIR)/bench_%: $(HOST_BUILD_DIR)/test/host/test/bench_%.o $(HOST_MODULE_OBJECTS)
+	$(HOST_CC) $(HOST_LDFLAGS) $^ -o $@
+
+-include $(wildcard $(HOST_BUILD_DIR)/*/*.d $(HOST_BUILD_DIR)/*/host/*.d $(HOST_BUILD_DIR)/*/host/test/*.d $(HOST_BUILD_DIR)/*/tools/*.d)
+
+.PHONY: host host-app host-tools
+
+.DEFAULT_GOAL           := $(HOST_DEFAULT_GOAL)
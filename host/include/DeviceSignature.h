@@ -0,0 +1,10 @@
+/**
+ * @brief Host stand-in, the device signature is not used by the application.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef DEVICESIGNATURE_H_
+#define DEVICESIGNATURE_H_
+
+#endif//DEVICESIGNATURE_H_
@@ -0,0 +1,57 @@
+/**
+ * @brief Host stand-in for the FreeRTOS kernel header. Static object types
+ * only reserve memory, the simulator keeps its own state.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef INC_FREERTOS_H
+#define INC_FREERTOS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Searched from the project directory for the application overrides
+#include <FreeRTOSConfig.h>
+
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint32_t StackType_t;
+
+#define pdFALSE 0
+#define pdTRUE  1
+#define pdFAIL  pdFALSE
+#define pdPASS  pdTRUE
+
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFFUL)
+
+// Interrupt handlers run to completion in the simulator, a requested
+// context switch happens when the host context next lets threads run
+#define portYIELD_FROM_ISR(woken) ((void)(woken))
+
+// Sizes of the Cortex-M4 port with run-time statistics and tracing
+typedef struct { uint32_t dummy[24]; } StaticTask_t;
+typedef struct { uint32_t dummy[11]; } StaticTimer_t;
+typedef struct { uint32_t dummy[20]; } StaticQueue_t;
+
+#ifndef traceTASK_INCREMENT_TICK
+#define traceTASK_INCREMENT_TICK(tick_count)
+#endif
+#ifndef traceTASK_SWITCHED_IN
+#define traceTASK_SWITCHED_IN()
+#endif
+#ifndef traceTASK_SWITCHED_OUT
+#define traceTASK_SWITCHED_OUT()
+#endif
+#ifndef portCONFIGURE_TIMER_FOR_RUN_TIME_STATS
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#endif
+
+/**
+ * @return Simulated heap left, objects created without memory are taken
+ *         from configTOTAL_HEAP_SIZE.
+ */
+size_t xPortGetFreeHeapSize (void);
+
+#endif//INC_FREERTOS_H
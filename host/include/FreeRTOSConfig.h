@@ -0,0 +1,20 @@
+/**
+ * @brief Host stand-in for the default FreeRTOS configuration, found by
+ * the include_next of the application FreeRTOSConfig.h.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef FREERTOSCONFIG_H_
+#define FREERTOSCONFIG_H_
+
+#define configTICK_RATE_HZ              1000
+#define configTOTAL_HEAP_SIZE           (16 * 1024)
+#define configMAX_TASK_NAME_LEN         16
+#define configGENERATE_RUN_TIME_STATS   0
+#define configUSE_TRACE_FACILITY        0
+#define INCLUDE_xTaskGetIdleTaskHandle  0
+#define configSUPPORT_STATIC_ALLOCATION 0
+#define configSUPPORT_DYNAMIC_ALLOCATION 1
+
+#endif//FREERTOSCONFIG_H_
@@ -0,0 +1,10 @@
+/**
+ * @brief Host stand-in, the device signature is not used by the application.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef SIGNATUREAREA_H_
+#define SIGNATUREAREA_H_
+
+#endif//SIGNATUREAREA_H_
@@ -0,0 +1,40 @@
+/**
+ * @brief Host stand-in for emlib register bit access.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef EM_BUS_H_
+#define EM_BUS_H_
+
+#include "em_device.h"
+
+static inline void BUS_RegBitWrite (volatile uint32_t *addr, unsigned int bit, unsigned int val)
+{
+    sim_sync();
+    *addr = (*addr & ~(1UL << bit)) | ((uint32_t)(val != 0) << bit);
+    sim_sync();
+}
+
+static inline void BUS_RegMaskedWrite (volatile uint32_t *addr, uint32_t mask, uint32_t val)
+{
+    sim_sync();
+    *addr = (*addr & ~mask) | (val & mask);
+    sim_sync();
+}
+
+static inline void BUS_RegMaskedSet (volatile uint32_t *addr, uint32_t mask)
+{
+    sim_sync();
+    *addr |= mask;
+    sim_sync();
+}
+
+static inline void BUS_RegMaskedClear (volatile uint32_t *addr, uint32_t mask)
+{
+    sim_sync();
+    *addr &= ~mask;
+    sim_sync();
+}
+
+#endif//EM_BUS_H_
@@ -0,0 +1,38 @@
+/**
+ * @brief Host stand-in for the emlib clock management unit, all high
+ * frequency clocks run at SIM_HFCLK_HZ.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef EM_CMU_H_
+#define EM_CMU_H_
+
+#include "em_device.h"
+
+#define SIM_HFCLK_HZ 38400000UL // tsb0 HFXO
+
+typedef enum
+{
+    cmuClock_CORE,
+    cmuClock_HFPER,
+    cmuClock_GPIO,
+    cmuClock_TIMER0,
+    cmuClock_TIMER1,
+    cmuClock_GPCRC,
+    cmuClock_LDMA,
+    cmuClock_LFE,
+    cmuClock_RTCC
+} CMU_Clock_TypeDef;
+
+typedef enum
+{
+    cmuSelect_LFRCO,
+    cmuSelect_LFXO
+} CMU_Select_TypeDef;
+
+void CMU_ClockEnable (CMU_Clock_TypeDef clock, bool enable);
+uint32_t CMU_ClockFreqGet (CMU_Clock_TypeDef clock);
+void CMU_ClockSelectSet (CMU_Clock_TypeDef clock, CMU_Select_TypeDef ref);
+
+#endif//EM_CMU_H_
@@ -0,0 +1,16 @@
+/**
+ * @brief Host stand-in for emlib critical sections.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef EM_CORE_H_
+#define EM_CORE_H_
+
+#include "em_device.h"
+
+#define CORE_DECLARE_IRQ_STATE uint32_t irqState = 0
+#define CORE_ENTER_CRITICAL()  ((void)irqState)
+#define CORE_EXIT_CRITICAL()   ((void)irqState)
+
+#endif//EM_CORE_H_
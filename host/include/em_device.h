@@ -0,0 +1,144 @@
+/**
+ * @brief Host stand-in for the EFR32MG12 device header. Peripheral
+ * registers are plain memory in the simulator, emlib calls and the
+ * simulator itself keep them consistent, see host/sim.h.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef EM_DEVICE_H_
+#define EM_DEVICE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define __IM  volatile const
+#define __OM  volatile
+#define __IOM volatile
+
+typedef enum
+{
+    LDMA_IRQn      = 9,
+    GPIO_EVEN_IRQn = 10,
+    TIMER0_IRQn    = 11,
+    GPIO_ODD_IRQn  = 18,
+    TIMER1_IRQn    = 19,
+    RTCC_IRQn      = 30
+} IRQn_Type;
+
+#define __NVIC_PRIO_BITS 3
+
+void NVIC_EnableIRQ (IRQn_Type irq);
+void NVIC_DisableIRQ (IRQn_Type irq);
+void NVIC_ClearPendingIRQ (IRQn_Type irq);
+void NVIC_SetPriority (IRQn_Type irq, uint32_t priority);
+
+// Interrupt handlers are called by the simulator with the kernel locked
+static inline void __disable_irq (void) {}
+static inline void __enable_irq (void) {}
+static inline uint32_t __get_PRIMASK (void) { return 0; }
+static inline void __set_PRIMASK (uint32_t primask) { (void)primask; }
+static inline void __DSB (void) {}
+static inline void __ISB (void) {}
+
+#define GPIO_PORTS 12
+
+typedef struct
+{
+    __IOM uint32_t CTRL;
+    __IOM uint32_t MODEL;
+    __IOM uint32_t MODEH;
+    __IOM uint32_t DOUT;
+    __IOM uint32_t DOUTTGL;
+    __IOM uint32_t DIN;      // Written by the simulator
+    __IOM uint32_t PINLOCKN;
+    __IOM uint32_t OVTDIS;
+} GPIO_P_TypeDef;
+
+typedef struct
+{
+    GPIO_P_TypeDef P[GPIO_PORTS];
+    __IOM uint32_t EXTIPSELL;
+    __IOM uint32_t EXTIPSELH;
+    __IOM uint32_t EXTIPINSELL;
+    __IOM uint32_t EXTIPINSELH;
+    __IOM uint32_t EXTIRISE;
+    __IOM uint32_t EXTIFALL;
+    __IOM uint32_t IF;
+    __IOM uint32_t IEN;
+} GPIO_TypeDef;
+
+typedef struct
+{
+    __IOM uint32_t CTRL;
+    __IOM uint32_t CCV;
+    __IOM uint32_t CCVB;
+} TIMER_CC_TypeDef;
+
+typedef struct
+{
+    __IOM uint32_t CTRL;
+    __IOM uint32_t STATUS;   // Running bit kept by TIMER_Enable()
+    __IOM uint32_t IF;
+    __IOM uint32_t IEN;
+    __IOM uint32_t TOP;
+    __IOM uint32_t TOPB;
+    __IOM uint32_t CNT;
+    __IOM uint32_t ROUTEPEN;
+    __IOM uint32_t ROUTELOC0;
+    TIMER_CC_TypeDef CC[4];
+} TIMER_TypeDef;
+
+typedef struct
+{
+    __IOM uint32_t DEMCR;
+} CoreDebug_Type;
+
+typedef struct
+{
+    __IOM uint32_t CTRL;
+    __IOM uint32_t CYCCNT;   // Follows the simulated clock
+} DWT_Type;
+
+typedef struct
+{
+    __IOM uint32_t CTRL;
+    __IOM uint32_t LOAD;
+    __IOM uint32_t VAL;
+} SysTick_Type;
+
+#define SysTick_CTRL_ENABLE_Msk    (1UL << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk (1UL << 24)
+#define DWT_CTRL_CYCCNT_ENA_Msk    (1UL << 0)
+
+extern GPIO_TypeDef sim_gpio;
+extern TIMER_TypeDef sim_timer[2];
+extern CoreDebug_Type sim_coredebug;
+extern DWT_Type sim_dwt;
+extern SysTick_Type sim_systick;
+
+#define GPIO      (&sim_gpio)
+#define TIMER0    (&sim_timer[0])
+#define TIMER1    (&sim_timer[1])
+#define CoreDebug (&sim_coredebug)
+#define DWT       (&sim_dwt)
+#define SysTick   (&sim_systick)
+
+/**
+ * Bring the simulated pins in line with the registers and record the
+ * changes, called by the emlib stand-ins after register writes.
+ */
+void sim_sync (void);
+
+/**
+ * Enter and leave an interrupt handler. A thread switch made due by the
+ * handler is deferred until the outermost handler returns, the scheduler
+ * suspend level of the kernel lock is not touched.
+ */
+void sim_irq_enter (void);
+void sim_irq_exit (void);
+
+// Start of the simulated application image, see imagecrc_image_start()
+extern uint8_t sim_image[];
+
+#endif//EM_DEVICE_H_
@@ -0,0 +1,16 @@
+/**
+ * @brief Host stand-in for the emlib energy management unit, sleep is not
+ * simulated.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef EM_EMU_H_
+#define EM_EMU_H_
+
+#include "em_device.h"
+
+void EMU_EnterEM1 (void);
+void EMU_EnterEM2 (bool restore);
+
+#endif//EM_EMU_H_
@@ -0,0 +1,117 @@
+/**
+ * @brief Host stand-in for emlib GPIO. Every output write is followed by
+ * sim_sync(), which applies DOUTTGL and records the pin transitions. It
+ * also comes before the write, for the DOUTTGL stores made directly: they
+ * are seen as one toggle at the next emlib call.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef EM_GPIO_H_
+#define EM_GPIO_H_
+
+#include "em_device.h"
+#include "em_bus.h"
+
+typedef enum
+{
+    gpioPortA = 0,
+    gpioPortB = 1,
+    gpioPortC = 2,
+    gpioPortD = 3,
+    gpioPortF = 5,
+    gpioPortI = 8,
+    gpioPortJ = 9,
+    gpioPortK = 10
+} GPIO_Port_TypeDef;
+
+typedef enum
+{
+    gpioModeDisabled        = 0,
+    gpioModeInput           = 1,
+    gpioModeInputPull       = 2,
+    gpioModeInputPullFilter = 3,
+    gpioModePushPull        = 4
+} GPIO_Mode_TypeDef;
+
+void GPIO_PinModeSet (GPIO_Port_TypeDef port, unsigned int pin, GPIO_Mode_TypeDef mode, unsigned int out);
+void GPIO_ExtIntConfig (GPIO_Port_TypeDef port, unsigned int pin, unsigned int intNo,
+                        bool risingEdge, bool fallingEdge, bool enable);
+
+/**
+ * Raise the pending and enabled GPIO interrupts, real interrupts fire as
+ * soon as they are enabled.
+ */
+void sim_gpio_irq (void);
+
+static inline void GPIO_PortOutToggle (GPIO_Port_TypeDef port, uint32_t pins)
+{
+    sim_sync();
+    GPIO->P[port].DOUTTGL = pins;
+    sim_sync();
+}
+
+static inline void GPIO_PortOutSetVal (GPIO_Port_TypeDef port, uint32_t val, uint32_t mask)
+{
+    sim_sync();
+    GPIO->P[port].DOUT = (GPIO->P[port].DOUT & ~mask) | (val & mask);
+    sim_sync();
+}
+
+static inline uint32_t GPIO_PortOutGet (GPIO_Port_TypeDef port)
+{
+    return GPIO->P[port].DOUT;
+}
+
+static inline uint32_t GPIO_PortInGet (GPIO_Port_TypeDef port)
+{
+    return GPIO->P[port].DIN;
+}
+
+static inline void GPIO_PinOutSet (GPIO_Port_TypeDef port, unsigned int pin)
+{
+    BUS_RegMaskedSet(&GPIO->P[port].DOUT, 1UL << pin);
+}
+
+static inline void GPIO_PinOutClear (GPIO_Port_TypeDef port, unsigned int pin)
+{
+    BUS_RegMaskedClear(&GPIO->P[port].DOUT, 1UL << pin);
+}
+
+static inline void GPIO_PinOutToggle (GPIO_Port_TypeDef port, unsigned int pin)
+{
+    GPIO_PortOutToggle(port, 1UL << pin);
+}
+
+static inline unsigned int GPIO_PinInGet (GPIO_Port_TypeDef port, unsigned int pin)
+{
+    return (GPIO->P[port].DIN >> pin) & 1;
+}
+
+static inline uint32_t GPIO_IntGet (void)
+{
+    return GPIO->IF;
+}
+
+static inline uint32_t GPIO_IntGetEnabled (void)
+{
+    return GPIO->IF & GPIO->IEN;
+}
+
+static inline void GPIO_IntClear (uint32_t flags)
+{
+    GPIO->IF &= ~flags;
+}
+
+static inline void GPIO_IntEnable (uint32_t flags)
+{
+    GPIO->IEN |= flags;
+    sim_gpio_irq();
+}
+
+static inline void GPIO_IntDisable (uint32_t flags)
+{
+    GPIO->IEN &= ~flags;
+}
+
+#endif//EM_GPIO_H_
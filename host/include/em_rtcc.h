@@ -0,0 +1,46 @@
+/**
+ * @brief Host stand-in for the emlib RTCC. The host build runs without
+ * tickless idle, which is the only RTCC user, the simulator only gives the
+ * counter. The rest is for the idle.c test, which provides it.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef EM_RTCC_H_
+#define EM_RTCC_H_
+
+#include "em_device.h"
+
+#define RTCC_IF_CC1  (1UL << 2)
+#define RTCC_IEN_CC1 (1UL << 2)
+
+typedef enum
+{
+    rtccCntPresc_1 = 0
+} RTCC_CntPresc_TypeDef;
+
+typedef struct
+{
+    bool enable;
+    bool debugRun;
+    RTCC_CntPresc_TypeDef presc;
+} RTCC_Init_TypeDef;
+
+typedef struct
+{
+    uint8_t chMode;
+} RTCC_CCChConf_TypeDef;
+
+#define RTCC_INIT_DEFAULT            { true, false, rtccCntPresc_1 }
+#define RTCC_CH_INIT_COMPARE_DEFAULT { 2 }
+
+uint32_t RTCC_CounterGet (void);
+void RTCC_Init (const RTCC_Init_TypeDef *init);
+void RTCC_Enable (bool enable);
+void RTCC_ChannelInit (int ch, const RTCC_CCChConf_TypeDef *conf);
+void RTCC_ChannelCCVSet (int ch, uint32_t value);
+void RTCC_IntClear (uint32_t flags);
+void RTCC_IntEnable (uint32_t flags);
+uint32_t RTCC_IntGetEnabled (void);
+
+#endif//EM_RTCC_H_
@@ -0,0 +1,142 @@
+/**
+ * @brief Host stand-in for emlib TIMER. The counter does not run, the
+ * simulator derives the frequency and duty cycle of routed compare outputs
+ * from the registers, buffered values take effect at once.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef EM_TIMER_H_
+#define EM_TIMER_H_
+
+#include "em_device.h"
+#include "em_bus.h"
+
+#define _TIMER_CTRL_PRESC_SHIFT       24
+#define _TIMER_CTRL_PRESC_MASK        0xF000000UL
+#define _TIMER_CC_CTRL_MODE_MASK      0x3UL
+#define TIMER_STATUS_RUNNING          (1UL << 0)
+
+#define TIMER_IF_OF                   (1UL << 0)
+#define TIMER_IF_UF                   (1UL << 1)
+#define TIMER_IF_CC0                  (1UL << 4)
+
+#define TIMER_ROUTEPEN_CC0PEN         (1UL << 0)
+#define TIMER_ROUTEPEN_CC1PEN         (1UL << 1)
+#define TIMER_ROUTEPEN_CC2PEN         (1UL << 2)
+#define TIMER_ROUTEPEN_CC3PEN         (1UL << 3)
+
+#define _TIMER_ROUTELOC0_CC0LOC_SHIFT 0
+#define _TIMER_ROUTELOC0_CC1LOC_SHIFT 8
+#define _TIMER_ROUTELOC0_CC2LOC_SHIFT 16
+#define _TIMER_ROUTELOC0_CC3LOC_SHIFT 24
+#define _TIMER_ROUTELOC0_CC0LOC_MASK  0x3FUL
+#define TIMER_ROUTELOC0_CC0LOC_LOC0   0UL
+
+typedef enum
+{
+    timerPrescale1    = 0,
+    timerPrescale2    = 1,
+    timerPrescale4    = 2,
+    timerPrescale8    = 3,
+    timerPrescale16   = 4,
+    timerPrescale32   = 5,
+    timerPrescale64   = 6,
+    timerPrescale128  = 7,
+    timerPrescale256  = 8,
+    timerPrescale512  = 9,
+    timerPrescale1024 = 10
+} TIMER_Prescale_TypeDef;
+
+typedef enum
+{
+    timerCCModeOff     = 0,
+    timerCCModeCapture = 1,
+    timerCCModeCompare = 2,
+    timerCCModePWM     = 3
+} TIMER_CCMode_TypeDef;
+
+typedef struct
+{
+    bool enable;
+    bool debugRun;
+    TIMER_Prescale_TypeDef prescale;
+} TIMER_Init_TypeDef;
+
+#define TIMER_INIT_DEFAULT { true, true, timerPrescale1 }
+
+typedef struct
+{
+    TIMER_CCMode_TypeDef mode;
+    bool outInvert;
+} TIMER_InitCC_TypeDef;
+
+#define TIMER_INITCC_DEFAULT { timerCCModeOff, false }
+
+static inline void TIMER_Enable (TIMER_TypeDef *timer, bool enable)
+{
+    BUS_RegMaskedWrite(&timer->STATUS, TIMER_STATUS_RUNNING, enable ? TIMER_STATUS_RUNNING : 0);
+}
+
+static inline void TIMER_Init (TIMER_TypeDef *timer, const TIMER_Init_TypeDef *init)
+{
+    timer->CNT = 0;
+    BUS_RegMaskedWrite(&timer->CTRL, _TIMER_CTRL_PRESC_MASK, (uint32_t)init->prescale << _TIMER_CTRL_PRESC_SHIFT);
+    TIMER_Enable(timer, init->enable);
+}
+
+static inline void TIMER_InitCC (TIMER_TypeDef *timer, unsigned int ch, const TIMER_InitCC_TypeDef *init)
+{
+    BUS_RegMaskedWrite(&timer->CC[ch].CTRL, _TIMER_CC_CTRL_MODE_MASK, (uint32_t)init->mode);
+}
+
+static inline void TIMER_TopSet (TIMER_TypeDef *timer, uint32_t val)
+{
+    timer->TOPB = val;
+    timer->TOP = val;
+    sim_sync();
+}
+
+static inline void TIMER_CompareSet (TIMER_TypeDef *timer, unsigned int ch, uint32_t val)
+{
+    timer->CC[ch].CCVB = val;
+    timer->CC[ch].CCV = val;
+    sim_sync();
+}
+
+static inline void TIMER_CompareBufSet (TIMER_TypeDef *timer, unsigned int ch, uint32_t val)
+{
+    TIMER_CompareSet(timer, ch, val);
+}
+
+static inline void TIMER_CounterSet (TIMER_TypeDef *timer, uint32_t val)
+{
+    timer->CNT = val;
+}
+
+static inline uint32_t TIMER_CounterGet (TIMER_TypeDef *timer)
+{
+    return timer->CNT;
+}
+
+static inline uint32_t TIMER_IntGet (TIMER_TypeDef *timer)
+{
+    return timer->IF;
+}
+
+static inline void TIMER_IntClear (TIMER_TypeDef *timer, uint32_t flags)
+{
+    timer->IF &= ~flags;
+}
+
+static inline void TIMER_IntEnable (TIMER_TypeDef *timer, uint32_t flags)
+{
+    timer->IEN |= flags;
+}
+
+static inline void TIMER_IntDisable (TIMER_TypeDef *timer, uint32_t flags)
+{
+    timer->IEN &= ~flags;
+}
+
+#endif//EM_TIMER_H_
@@ -0,0 +1,16 @@
+/**
+ * @brief Host stand-in for incbin. There is no header.bin without
+ * HEADEREDIT, appheader_data.c is left out of the host build and the
+ * simulator provides the data, see host/sim_platform.c.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef INCBIN_H_
+#define INCBIN_H_
+
+#define INCBIN_EXTERN(name) \
+    extern const unsigned char g##name##Data[]; \
+    extern const unsigned int g##name##Size
+
+#endif//INCBIN_H_
@@ -0,0 +1,35 @@
+/**
+ * @brief Host stand-in for the lll logging macros. A module defines
+ * __MODUUL__ and __LOG_LEVEL__ before including this header, messages are
+ * formatted with the simulated time and passed to the log_init() writer.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef LOG_H_
+#define LOG_H_
+
+#include <stdint.h>
+
+#define LOG_DEBUG1 0x0001
+#define LOG_INFO1  0x0100
+#define LOG_WARN1  0x2000
+#define LOG_ERR1   0x4000
+
+#define LOG_LEVEL_DEBUG 0xFFFF
+#define LOG_LEVEL_INFO  0xFFFE
+#define LOG_LEVEL_WARN  0xF000
+#define LOG_LEVEL_ERR   0xC000
+#define LOG_LEVEL_NONE  0x0000
+
+typedef int (*log_writer_f) (const char *ptr, int len);
+
+void log_init (uint16_t level, log_writer_f writer, void *arg);
+void log_write (uint16_t flag, const char *module, const char *fmt, ...) __attribute__((format(printf, 3, 4)));
+
+#define debug1(fmt, ...) do { if ((__LOG_LEVEL__) & LOG_DEBUG1) log_write(LOG_DEBUG1, __MODUUL__, fmt, ##__VA_ARGS__); } while (0)
+#define info1(fmt, ...)  do { if ((__LOG_LEVEL__) & LOG_INFO1) log_write(LOG_INFO1, __MODUUL__, fmt, ##__VA_ARGS__); } while (0)
+#define warn1(fmt, ...)  do { if ((__LOG_LEVEL__) & LOG_WARN1) log_write(LOG_WARN1, __MODUUL__, fmt, ##__VA_ARGS__); } while (0)
+#define err1(fmt, ...)   do { if ((__LOG_LEVEL__) & LOG_ERR1) log_write(LOG_ERR1, __MODUUL__, fmt, ##__VA_ARGS__); } while (0)
+
+#endif//LOG_H_
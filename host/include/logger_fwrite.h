@@ -0,0 +1,13 @@
+/**
+ * @brief Host stand-in for the thread-safe stdout logger.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef LOGGER_FWRITE_H_
+#define LOGGER_FWRITE_H_
+
+void logger_fwrite_init (void);
+int logger_fwrite (const char *ptr, int len);
+
+#endif//LOGGER_FWRITE_H_
@@ -0,0 +1,12 @@
+/**
+ * @brief Host stand-in for the lll logger declarations, see log.h.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef LOGGERS_EXT_H_
+#define LOGGERS_EXT_H_
+
+#include "log.h"
+
+#endif//LOGGERS_EXT_H_
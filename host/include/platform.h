@@ -0,0 +1,12 @@
+/**
+ * @brief Host stand-in for the node platform setup.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef PLATFORM_H_
+#define PLATFORM_H_
+
+void PLATFORM_Init (void);
+
+#endif//PLATFORM_H_
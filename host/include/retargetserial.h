@@ -0,0 +1,13 @@
+/**
+ * @brief Host stand-in for the serial port retargeting, stdout is the
+ * serial port.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef RETARGETSERIAL_H_
+#define RETARGETSERIAL_H_
+
+void RETARGET_SerialInit (void);
+
+#endif//RETARGETSERIAL_H_
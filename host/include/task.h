@@ -0,0 +1,53 @@
+/**
+ * @brief Host stand-in for the FreeRTOS task API used by the profilers.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef INC_TASK_H
+#define INC_TASK_H
+
+#include "FreeRTOS.h"
+
+typedef void * TaskHandle_t;
+
+typedef enum
+{
+    eRunning = 0,
+    eReady,
+    eBlocked,
+    eSuspended,
+    eDeleted,
+    eInvalid
+} eTaskState;
+
+typedef enum
+{
+    eAbortSleep = 0,
+    eStandardSleep,
+    eNoTasksWaitingTimeout
+} eSleepModeStatus;
+
+typedef struct
+{
+    TaskHandle_t xHandle;
+    const char *pcTaskName;
+    UBaseType_t xTaskNumber;
+    eTaskState eCurrentState;
+    UBaseType_t uxCurrentPriority;
+    UBaseType_t uxBasePriority;
+    uint32_t ulRunTimeCounter;
+    StackType_t *pxStackBase;
+    uint16_t usStackHighWaterMark;
+} TaskStatus_t;
+
+TaskHandle_t xTaskGetCurrentTaskHandle (void);
+TaskHandle_t xTaskGetIdleTaskHandle (void);
+const char *pcTaskGetName (TaskHandle_t task);
+UBaseType_t uxTaskGetSystemState (TaskStatus_t * const status, const UBaseType_t count, uint32_t * const total_run_time);
+
+// Tickless idle is not simulated, declared for idle.c
+void vTaskStepTick (const TickType_t ticks);
+eSleepModeStatus eTaskConfirmSleepModeStatus (void);
+
+#endif//INC_TASK_H
@@ -0,0 +1,17 @@
+/**
+ * @brief Host stand-in for the FreeRTOS timer API, CMSIS timer handles are
+ * timer handles as in CMSIS-FreeRTOS.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef TIMERS_H
+#define TIMERS_H
+
+#include "FreeRTOS.h"
+
+typedef void * TimerHandle_t;
+
+BaseType_t xTimerChangePeriodFromISR (TimerHandle_t timer, TickType_t period, BaseType_t *woken);
+
+#endif//TIMERS_H
@@ -0,0 +1,140 @@
+/**
+ * @brief Host simulation of the tsb0 board and the RTOS, for running the
+ * application and its modules on Linux without hardware.
+ *
+ * Pins are memory: the GPIO and TIMER registers of the emlib stand-ins
+ * are plain variables and every change of a pin is recorded with the
+ * simulated time. A pin driven by a routed TIMER compare output records
+ * its frequency and duty cycle instead of a level. Input pins are driven
+ * with sim_pin_input(), which raises the configured edge interrupts.
+ *
+ * The CMSIS-RTOS2 threads are pthreads that run one at a time in priority
+ * order, so a run is deterministic. Time is a virtual tick count that only
+ * advances while all threads are blocked: sim_advance() skips to the next
+ * timer, timeout or injected event, runs it and lets the woken threads
+ * run. The application binary runs for SIM_RUN_MS, at SIM_SPEED times
+ * real time or as fast as possible with 0, and prints the pin trace.
+ *
+ * The kernel lock keeps the scheduler suspend level of CMSIS-FreeRTOS,
+ * osKernelRestoreLock(1) suspends once more, and the uses that assert or
+ * hang on the target are counted by sim_faults().
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef SIM_H_
+#define SIM_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "cmsis_os2.h"
+
+typedef struct
+{
+    uint32_t tick;  // Simulated time, kernel ticks
+    uint8_t port;
+    uint8_t pin;
+    uint8_t level;  // Pin level, 1 while a timer output drives it
+    uint16_t duty;  // Timer output duty cycle out of 256, 0 for a level
+    uint32_t hz;    // Timer output frequency, 0 for a level
+    uint32_t sync;  // Pin update that saw the change, the changes of one
+                    // register write share it
+} sim_trace_t;
+
+typedef void (*sim_event_f)(void * argument);
+
+/**
+ * Let the threads created so far run, tests call this instead of
+ * osKernelStart(), which does not return.
+ */
+void sim_start (void);
+
+/**
+ * Advance the simulated time. Each tick with something due runs the
+ * injected events, then the due timer callbacks and then the threads until
+ * all of them are blocked again, the ticks in between are skipped.
+ */
+void sim_advance (uint32_t ticks);
+
+/**
+ * Advance the simulated time to a tick, see sim_advance().
+ */
+void sim_run_until (uint32_t tick);
+
+/**
+ * Run the ready threads until all of them are blocked.
+ */
+void sim_idle (void);
+
+/**
+ * Call a function at a tick in interrupt context, before the timer
+ * callbacks of that tick. Events of the same tick run in the order they
+ * were added, a tick in the past means the next one.
+ */
+void sim_at (uint32_t tick, sim_event_f func, void * argument);
+
+/**
+ * Drive an input pin at a tick, see sim_at() and sim_pin_input().
+ */
+void sim_pin_at (uint32_t tick, uint8_t port, uint8_t pin, bool level);
+
+/**
+ * Make osKernelStart() run the application for a number of ticks and
+ * then exit with the result of done, instead of SIM_RUN_MS and the trace.
+ */
+void sim_kernel_run (uint32_t ticks, int (*done)(void));
+
+/**
+ * @return Number of kernel uses that assert or hang on the target, each is
+ *         also reported on stderr: a thread that blocks or a run that ends
+ *         with the scheduler suspended, a resume without a suspend.
+ */
+uint32_t sim_faults (void);
+
+/**
+ * Set the free stack space that osThreadGetStackSpace() reports for a
+ * thread. Host stacks are not measured, a thread reports its whole stack
+ * free until this is called.
+ */
+void sim_stack_space (osThreadId_t thread, uint32_t space);
+
+/**
+ * @return Simulated time, kernel ticks.
+ */
+uint32_t sim_now (void);
+
+/**
+ * Drive an input pin from outside, edges raise the configured GPIO
+ * interrupts. Threads woken by the interrupt run on the next
+ * sim_advance() or sim_idle().
+ */
+void sim_pin_input (uint8_t port, uint8_t pin, bool level);
+
+/**
+ * @return Current state of a pin, NULL if it has not been recorded.
+ */
+const sim_trace_t * sim_pin (uint8_t port, uint8_t pin);
+
+/**
+ * @return Number of recorded pin changes.
+ */
+uint32_t sim_trace_count (void);
+
+/**
+ * @return A recorded pin change, in the order of the changes.
+ */
+const sim_trace_t * sim_trace_get (uint32_t index);
+
+/**
+ * Forget the recorded pin changes, the current pin states are kept.
+ */
+void sim_trace_clear (void);
+
+/**
+ * Print the recorded pin changes, one per line.
+ */
+void sim_trace_print (FILE * out);
+
+#endif//SIM_H_
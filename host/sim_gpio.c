@@ -0,0 +1,372 @@
+/**
+ * @brief Simulated GPIO, TIMER outputs, CMU and NVIC, with the pin
+ * transition recorder.
+ *
+ * sim_sync() folds DOUTTGL into DOUT, reads back output levels into DIN
+ * and compares every configured pin with its last recorded state. Pins
+ * driven by a routed TIMER compare output in PWM mode are recorded with
+ * the frequency and duty cycle computed from the timer registers.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include "sim.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <pthread.h>
+
+#include "cmsis_os2.h"
+
+#include "em_device.h"
+#include "em_cmu.h"
+#include "em_gpio.h"
+#include "em_timer.h"
+
+#define SIM_PINS      16 // Per port
+#define SIM_EXTINT    16 // External interrupt numbers
+#define SIM_TIMERS    (sizeof(sim_timer) / sizeof(sim_timer[0]))
+#define SIM_CC_LOCS   32 // Compare output locations, shifted by one per channel
+#define SIM_EVEN_MASK 0x5555
+#define SIM_ODD_MASK  0xAAAA
+
+GPIO_TypeDef sim_gpio;
+TIMER_TypeDef sim_timer[2];
+CoreDebug_Type sim_coredebug;
+DWT_Type sim_dwt;
+SysTick_Type sim_systick;
+
+// EFR32MG12 TIMER compare output location n of channel 0, channel c uses
+// the entry at n + c
+static const uint8_t m_cc_locs[SIM_CC_LOCS][2] = {
+    { gpioPortA, 0 },  { gpioPortA, 1 },  { gpioPortA, 2 },  { gpioPortA, 3 },
+    { gpioPortA, 4 },  { gpioPortA, 5 },  { gpioPortB, 11 }, { gpioPortB, 12 },
+    { gpioPortB, 13 }, { gpioPortB, 14 }, { gpioPortB, 15 }, { gpioPortC, 6 },
+    { gpioPortC, 7 },  { gpioPortC, 8 },  { gpioPortC, 9 },  { gpioPortC, 10 },
+    { gpioPortC, 11 }, { gpioPortD, 9 },  { gpioPortD, 10 }, { gpioPortD, 11 },
+    { gpioPortD, 12 }, { gpioPortD, 13 }, { gpioPortD, 14 }, { gpioPortD, 15 },
+    { gpioPortF, 0 },  { gpioPortF, 1 },  { gpioPortF, 2 },  { gpioPortF, 3 },
+    { gpioPortF, 4 },  { gpioPortF, 5 },  { gpioPortF, 6 },  { gpioPortF, 7 },
+};
+
+typedef struct
+{
+    uint8_t port;
+    uint8_t pin;
+} sim_extint_t;
+
+static pthread_mutex_t m_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static sim_trace_t m_pins[GPIO_PORTS][SIM_PINS];
+static bool m_known[GPIO_PORTS][SIM_PINS];
+static uint32_t m_driven[GPIO_PORTS]; // Inputs driven by sim_pin_input()
+static sim_extint_t m_extint[SIM_EXTINT];
+
+static sim_trace_t * m_trace;
+static uint32_t m_trace_count;
+static uint32_t m_trace_size;
+static uint32_t m_syncs;
+
+static uint64_t m_nvic_enabled;
+static bool m_in_irq;
+
+__attribute__((weak)) void GPIO_EVEN_IRQHandler (void)
+{
+}
+
+__attribute__((weak)) void GPIO_ODD_IRQHandler (void)
+{
+}
+
+static uint32_t pin_mode (const GPIO_P_TypeDef * p, uint8_t pin)
+{
+    uint32_t model = (pin < 8) ? p->MODEL : p->MODEH;
+    return (model >> ((pin & 7) * 4)) & 0xF;
+}
+
+// State of a pin driven by a timer output, false if none drives it
+static bool timer_output (uint8_t port, uint8_t pin, sim_trace_t * s)
+{
+    for (uint32_t t = 0; t < SIM_TIMERS; t++)
+    {
+        const TIMER_TypeDef * timer = &sim_timer[t];
+
+        for (uint8_t cc = 0; cc < 4; cc++)
+        {
+            uint32_t loc = (timer->ROUTELOC0 >> (cc * 8)) & _TIMER_ROUTELOC0_CC0LOC_MASK;
+            const uint8_t * at = m_cc_locs[(loc + cc) % SIM_CC_LOCS];
+
+            if (((timer->ROUTEPEN & (1UL << cc)) == 0) || (at[0] != port) || (at[1] != pin))
+            {
+                continue;
+            }
+
+            // A stopped timer leaves its output low
+            s->level = 0;
+            if ((timer->STATUS & TIMER_STATUS_RUNNING)
+             && ((timer->CC[cc].CTRL & _TIMER_CC_CTRL_MODE_MASK) == timerCCModePWM))
+            {
+                uint32_t presc = (timer->CTRL & _TIMER_CTRL_PRESC_MASK) >> _TIMER_CTRL_PRESC_SHIFT;
+                uint64_t period = (uint64_t)timer->TOP + 1;
+                uint64_t duty = (uint64_t)timer->CC[cc].CCV * 256 / period;
+
+                if (duty >= 256)
+                {
+                    s->level = 1;
+                }
+                else if (duty > 0)
+                {
+                    s->level = 1;
+                    s->duty = (uint16_t)duty;
+                    s->hz = (uint32_t)((SIM_HFCLK_HZ >> presc) / period);
+                }
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+// Append a pin state if it differs from the last one, called with m_mutex
+static void record (const sim_trace_t * s)
+{
+    sim_trace_t * last = &m_pins[s->port][s->pin];
+
+    if (m_known[s->port][s->pin] && (last->level == s->level) && (last->duty == s->duty) && (last->hz == s->hz))
+    {
+        return;
+    }
+    *last = *s;
+    m_known[s->port][s->pin] = true;
+
+    if (m_trace_count == m_trace_size)
+    {
+        m_trace_size = (m_trace_size > 0) ? m_trace_size * 2 : 1024;
+        m_trace = realloc(m_trace, m_trace_size * sizeof(sim_trace_t));
+        if (m_trace == NULL)
+        {
+            abort();
+        }
+    }
+    m_trace[m_trace_count++] = *s;
+}
+
+void sim_sync (void)
+{
+    uint32_t now = sim_now();
+
+    pthread_mutex_lock(&m_mutex);
+    uint32_t sync = ++m_syncs;
+    for (uint8_t port = 0; port < GPIO_PORTS; port++)
+    {
+        GPIO_P_TypeDef * p = &sim_gpio.P[port];
+
+        if (p->DOUTTGL != 0)
+        {
+            p->DOUT ^= p->DOUTTGL;
+            p->DOUTTGL = 0;
+        }
+
+        for (uint8_t pin = 0; pin < SIM_PINS; pin++)
+        {
+            uint32_t mode = pin_mode(p, pin);
+            uint32_t bit = 1UL << pin;
+            sim_trace_t s = { .tick = now, .port = port, .pin = pin, .sync = sync };
+
+            if (mode == gpioModeDisabled)
+            {
+                continue;
+            }
+            if (mode >= gpioModePushPull)
+            {
+                if (!timer_output(port, pin, &s))
+                {
+                    s.level = (p->DOUT & bit) ? 1 : 0;
+                }
+                p->DIN = (p->DIN & ~bit) | (s.level ? bit : 0);
+            }
+            else
+            {
+                // Undriven inputs follow their pull resistor
+                if (((m_driven[port] & bit) == 0) && (mode != gpioModeInput))
+                {
+                    p->DIN = (p->DIN & ~bit) | (p->DOUT & bit);
+                }
+                s.level = (p->DIN & bit) ? 1 : 0;
+            }
+            record(&s);
+        }
+    }
+    pthread_mutex_unlock(&m_mutex);
+}
+
+void sim_gpio_irq (void)
+{
+    uint32_t pending = GPIO->IF & GPIO->IEN;
+
+    if ((pending == 0) || m_in_irq)
+    {
+        return;
+    }
+
+    // Interrupt handlers run to completion, a switch waits for the return
+    sim_irq_enter();
+    m_in_irq = true;
+    if ((pending & SIM_EVEN_MASK) && (m_nvic_enabled & (1ULL << GPIO_EVEN_IRQn)))
+    {
+        GPIO_EVEN_IRQHandler();
+    }
+    if ((pending & SIM_ODD_MASK) && (m_nvic_enabled & (1ULL << GPIO_ODD_IRQn)))
+    {
+        GPIO_ODD_IRQHandler();
+    }
+    m_in_irq = false;
+    sim_irq_exit();
+}
+
+void sim_pin_input (uint8_t port, uint8_t pin, bool level)
+{
+    uint32_t bit = 1UL << pin;
+
+    pthread_mutex_lock(&m_mutex);
+    bool changed = ((GPIO->P[port].DIN & bit) != 0) != level;
+    m_driven[port] |= bit;
+    GPIO->P[port].DIN = (GPIO->P[port].DIN & ~bit) | (level ? bit : 0);
+    pthread_mutex_unlock(&m_mutex);
+    sim_sync();
+
+    if (!changed)
+    {
+        return;
+    }
+    for (uint8_t i = 0; i < SIM_EXTINT; i++)
+    {
+        uint32_t edges = level ? GPIO->EXTIRISE : GPIO->EXTIFALL;
+
+        if ((m_extint[i].port == port) && (m_extint[i].pin == pin) && (edges & (1UL << i)))
+        {
+            GPIO->IF |= (1UL << i);
+        }
+    }
+    sim_gpio_irq();
+}
+
+const sim_trace_t * sim_pin (uint8_t port, uint8_t pin)
+{
+    sim_sync();
+    return m_known[port][pin] ? &m_pins[port][pin] : NULL;
+}
+
+uint32_t sim_trace_count (void)
+{
+    sim_sync();
+    return m_trace_count;
+}
+
+const sim_trace_t * sim_trace_get (uint32_t index)
+{
+    return (index < m_trace_count) ? &m_trace[index] : NULL;
+}
+
+void sim_trace_clear (void)
+{
+    sim_sync();
+    pthread_mutex_lock(&m_mutex);
+    m_trace_count = 0;
+    pthread_mutex_unlock(&m_mutex);
+}
+
+void sim_trace_print (FILE * out)
+{
+    uint32_t count = sim_trace_count();
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const sim_trace_t * s = &m_trace[i];
+
+        if (s->hz != 0)
+        {
+            fprintf(out, "%10"PRIu32" P%c%-2u pwm %"PRIu32" Hz %u/256\n", s->tick, 'A' + s->port, s->pin, s->hz, s->duty);
+        }
+        else
+        {
+            fprintf(out, "%10"PRIu32" P%c%-2u %u\n", s->tick, 'A' + s->port, s->pin, s->level);
+        }
+    }
+}
+
+void GPIO_PinModeSet (GPIO_Port_TypeDef port, unsigned int pin, GPIO_Mode_TypeDef mode, unsigned int out)
+{
+    volatile uint32_t * model = (pin < 8) ? &GPIO->P[port].MODEL : &GPIO->P[port].MODEH;
+
+    GPIO->P[port].DOUT = (GPIO->P[port].DOUT & ~(1UL << pin)) | ((out ? 1UL : 0) << pin);
+    *model = (*model & ~(0xFUL << ((pin & 7) * 4))) | ((uint32_t)mode << ((pin & 7) * 4));
+    sim_sync();
+}
+
+void GPIO_ExtIntConfig (GPIO_Port_TypeDef port, unsigned int pin, unsigned int intNo,
+                        bool risingEdge, bool fallingEdge, bool enable)
+{
+    uint32_t bit = 1UL << intNo;
+
+    m_extint[intNo].port = port;
+    m_extint[intNo].pin = pin;
+    GPIO->EXTIRISE = (GPIO->EXTIRISE & ~bit) | (risingEdge ? bit : 0);
+    GPIO->EXTIFALL = (GPIO->EXTIFALL & ~bit) | (fallingEdge ? bit : 0);
+    GPIO->IF &= ~bit;
+    if (enable)
+    {
+        GPIO_IntEnable(bit);
+    }
+    else
+    {
+        GPIO_IntDisable(bit);
+    }
+}
+
+void NVIC_EnableIRQ (IRQn_Type irq)
+{
+    __atomic_fetch_or(&m_nvic_enabled, 1ULL << irq, __ATOMIC_RELAXED);
+    if ((irq == GPIO_EVEN_IRQn) || (irq == GPIO_ODD_IRQn))
+    {
+        sim_gpio_irq();
+    }
+}
+
+void NVIC_DisableIRQ (IRQn_Type irq)
+{
+    __atomic_fetch_and(&m_nvic_enabled, ~(1ULL << irq), __ATOMIC_RELAXED);
+}
+
+void NVIC_ClearPendingIRQ (IRQn_Type irq)
+{
+    (void)irq;
+}
+
+void NVIC_SetPriority (IRQn_Type irq, uint32_t priority)
+{
+    (void)irq;
+    (void)priority;
+}
+
+void CMU_ClockEnable (CMU_Clock_TypeDef clock, bool enable)
+{
+    (void)clock;
+    (void)enable;
+}
+
+uint32_t CMU_ClockFreqGet (CMU_Clock_TypeDef clock)
+{
+    if ((clock == cmuClock_LFE) || (clock == cmuClock_RTCC))
+    {
+        return 32768;
+    }
+    return SIM_HFCLK_HZ;
+}
+
+void CMU_ClockSelectSet (CMU_Clock_TypeDef clock, CMU_Select_TypeDef ref)
+{
+    (void)clock;
+    (void)ref;
+}
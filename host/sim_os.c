@@ -0,0 +1,1129 @@
+/**
+ * @brief Deterministic CMSIS-RTOS2 on pthreads with a virtual tick.
+ *
+ * Every thread is a pthread, but only one of them runs at a time: the
+ * running context holds the baton and hands it over when it blocks,
+ * yields or makes a thread of higher priority ready, as the FreeRTOS
+ * scheduler would without time slicing. Ready threads run in priority
+ * order, threads of equal priority in the order they became ready. The
+ * host context (tests, injected events, timer callbacks) holds the baton
+ * while no thread is ready, it stands for the interrupts and the timer
+ * daemon. The kernel lock defers preemption until it is released.
+ *
+ * Time does not pass while threads run. sim_run_until() advances the
+ * tick, skipping straight to the next timer, timeout or injected event
+ * while all threads are blocked. Each tick runs the injected events and
+ * then the due timer callbacks, and lets the woken threads run. The same
+ * inputs give the same pin trace on every run.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#define _GNU_SOURCE
+#include "sim.h"
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "cmsis_os2.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+
+#include "em_device.h"
+#include "em_cmu.h"
+
+#define SIM_SPEED_DEFAULT  0     // Times real time, 0 runs as fast as possible
+#define SIM_RUN_MS_DEFAULT 60000 // Simulated run time of the application
+
+typedef struct sim_thread sim_thread_t;
+typedef bool (*sim_ready_f)(const sim_thread_t * t);
+
+struct sim_thread
+{
+    pthread_t pthread;
+    const char * name;
+    osThreadFunc_t func;
+    void * argument;
+    osPriority_t priority;
+    uint32_t stack_size;
+    uint32_t stack_space; // Reported free stack, see sim_stack_space()
+    uint32_t flags;
+    uint32_t order; // When the thread became ready, lower runs first
+    // Wait state
+    bool blocked;
+    sim_ready_f ready;
+    void * object;
+    uint32_t mask;
+    uint32_t options;
+    bool timed;
+    uint32_t deadline;
+    bool exited;
+    sim_thread_t * next;
+};
+
+typedef struct sim_timer
+{
+    osTimerFunc_t func;
+    void * argument;
+    osTimerType_t type;
+    const char * name;
+    bool running;
+    uint32_t deadline;
+    uint32_t period;
+    uint32_t order; // Start order, timers due on the same tick run in it
+    struct sim_timer * next;
+} sim_timer_t;
+
+typedef struct sim_event
+{
+    uint32_t tick;
+    sim_event_f func;
+    void * argument;
+    struct sim_event * next;
+} sim_event_t;
+
+typedef struct
+{
+    uint8_t port;
+    uint8_t pin;
+    bool level;
+} sim_pin_event_t;
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t size;
+    uint32_t head;
+    uint32_t used;
+    uint8_t * buffer;
+} sim_queue_t;
+
+static pthread_mutex_t m_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t m_cond = PTHREAD_COND_INITIALIZER;
+
+static osKernelState_t m_state = osKernelInactive;
+static uint32_t m_suspended; // Scheduler suspend level, as uxSchedulerSuspended
+static uint32_t m_irq_nesting;
+static bool m_preempt; // A switch was deferred by the kernel lock or an interrupt
+static uint32_t m_faults;
+static uint32_t m_tick;
+
+static sim_thread_t * m_threads;
+static sim_thread_t * m_current; // Holds the baton, NULL for the host context
+static uint32_t m_ready_order;
+static sim_timer_t * m_timers;
+static uint32_t m_timer_order;
+static sim_event_t * m_events; // Sorted by tick, then by insertion
+static size_t m_heap_free = configTOTAL_HEAP_SIZE;
+
+static uint32_t m_run_ticks;
+static int (*m_run_done)(void);
+
+static __thread sim_thread_t * m_self;
+
+// Idle task handle for the profilers, stands for the host context
+static sim_thread_t m_idle = { .name = "IDLE", .blocked = true, .priority = osPriorityIdle };
+
+static void heap_take (const void * mem, size_t size)
+{
+    if ((mem == NULL) && (m_heap_free >= size))
+    {
+        m_heap_free -= size;
+    }
+}
+
+// CMSIS-FreeRTOS creates an object in the given memory only with static
+// allocation and one without memory only with dynamic allocation, given
+// control block memory that is too small or partial memory fails as well
+static bool allocation (bool given, bool complete, bool none)
+{
+    if (given)
+    {
+        return complete && (configSUPPORT_STATIC_ALLOCATION == 1);
+    }
+    return none && (configSUPPORT_DYNAMIC_ALLOCATION == 1);
+}
+
+static bool due (uint32_t deadline)
+{
+    return (int32_t)(m_tick - deadline) >= 0;
+}
+
+static bool never (const sim_thread_t * t)
+{
+    (void)t;
+    return false;
+}
+
+static bool started (void)
+{
+    return (m_state == osKernelRunning) || (m_state == osKernelLocked);
+}
+
+// A use of the kernel that asserts or hangs on the target
+static void fault (const char * what)
+{
+    const char * name = (m_self != NULL) ? m_self->name : NULL;
+
+    m_faults++;
+    fprintf(stderr, "sim: tick %"PRIu32" %s: %s\n", m_tick, (name != NULL) ? name : "host", what);
+}
+
+// Make ready the blocked threads that can continue, called with m_mutex
+static void wake (void)
+{
+    for (sim_thread_t * t = m_threads; t != NULL; t = t->next)
+    {
+        if (t->blocked && !t->exited && (t->ready(t) || (t->timed && due(t->deadline))))
+        {
+            t->blocked = false;
+            t->order = m_ready_order++;
+        }
+    }
+}
+
+// Highest priority ready thread, the longest ready first, called with m_mutex
+static sim_thread_t * pick (void)
+{
+    sim_thread_t * next = NULL;
+
+    if (!started())
+    {
+        return NULL;
+    }
+    wake();
+    for (sim_thread_t * t = m_threads; t != NULL; t = t->next)
+    {
+        if (t->blocked || t->exited || (t == m_self))
+        {
+            continue;
+        }
+        if ((next == NULL) || (t->priority > next->priority)
+         || ((t->priority == next->priority) && ((int32_t)(t->order - next->order) < 0)))
+        {
+            next = t;
+        }
+    }
+    return next;
+}
+
+// Hand the baton over and wait until it comes back, called with m_mutex
+static void switch_to (sim_thread_t * next, bool back)
+{
+    traceTASK_SWITCHED_OUT();
+    m_current = next;
+    traceTASK_SWITCHED_IN();
+    pthread_cond_broadcast(&m_cond);
+    while (back && (m_current != m_self))
+    {
+        pthread_cond_wait(&m_cond, &m_mutex);
+    }
+}
+
+// The calling thread stops running, blocked or exited, called with m_mutex
+static void dispatch (bool back)
+{
+    switch_to(pick(), back);
+}
+
+// Switch to a thread of higher priority made ready by the calling thread,
+// called with m_mutex
+static void preempt (void)
+{
+    sim_thread_t * self = m_self;
+
+    if ((self == NULL) || !started())
+    {
+        return;
+    }
+    if ((m_suspended > 0) || (m_irq_nesting > 0))
+    {
+        m_preempt = true;
+        return;
+    }
+    m_preempt = false;
+
+    sim_thread_t * next = pick();
+    if ((next != NULL) && (next->priority > self->priority))
+    {
+        self->order = m_ready_order++;
+        switch_to(next, true);
+    }
+}
+
+// Block the calling thread until ready() or the timeout, called with m_mutex
+static bool wait (sim_ready_f ready, void * object, uint32_t timeout)
+{
+    sim_thread_t * t = m_self;
+
+    if (ready(t))
+    {
+        return true;
+    }
+    if ((timeout == 0) || (t == NULL))
+    {
+        return false;
+    }
+    // configASSERT in the blocking calls, the switch happens regardless here
+    if (m_suspended > 0)
+    {
+        fault("blocks with the scheduler suspended");
+    }
+
+    t->ready = ready;
+    t->object = object;
+    t->timed = (timeout != osWaitForever);
+    t->deadline = m_tick + timeout;
+    while (true)
+    {
+        t->blocked = true;
+        dispatch(true);
+        // Another thread may have taken what woke this one up
+        if (ready(t))
+        {
+            return true;
+        }
+        if (t->timed && due(t->deadline))
+        {
+            return false;
+        }
+    }
+}
+
+static void * thread_entry (void * argument)
+{
+    sim_thread_t * t = argument;
+
+    m_self = t;
+    pthread_mutex_lock(&m_mutex);
+    while (m_current != t)
+    {
+        pthread_cond_wait(&m_cond, &m_mutex);
+    }
+    pthread_mutex_unlock(&m_mutex);
+
+    t->func(t->argument);
+
+    pthread_mutex_lock(&m_mutex);
+    t->exited = true;
+    dispatch(false);
+    pthread_mutex_unlock(&m_mutex);
+    return NULL;
+}
+
+// Earliest due running timer, called with m_mutex
+static sim_timer_t * next_due_timer (void)
+{
+    sim_timer_t * next = NULL;
+
+    for (sim_timer_t * tm = m_timers; tm != NULL; tm = tm->next)
+    {
+        if (!tm->running || !due(tm->deadline))
+        {
+            continue;
+        }
+        if ((next == NULL) || ((int32_t)(tm->deadline - next->deadline) < 0)
+         || ((tm->deadline == next->deadline) && (tm->order < next->order)))
+        {
+            next = tm;
+        }
+    }
+    return next;
+}
+
+// Tick of the next timer, timeout or event after now, called with m_mutex
+static bool next_deadline (uint32_t * next)
+{
+    bool found = false;
+
+    for (sim_timer_t * tm = m_timers; tm != NULL; tm = tm->next)
+    {
+        if (tm->running && (!found || ((int32_t)(tm->deadline - *next) < 0)))
+        {
+            *next = tm->deadline;
+            found = true;
+        }
+    }
+    for (sim_thread_t * t = m_threads; t != NULL; t = t->next)
+    {
+        if (t->blocked && t->timed && !t->exited && (!found || ((int32_t)(t->deadline - *next) < 0)))
+        {
+            *next = t->deadline;
+            found = true;
+        }
+    }
+    if ((m_events != NULL) && (!found || ((int32_t)(m_events->tick - *next) < 0)))
+    {
+        *next = m_events->tick;
+        found = true;
+    }
+    return found;
+}
+
+// One kernel tick in the host context, the injected events run first as
+// interrupts, then the timer callbacks as the timer daemon would
+static void tick (void)
+{
+    sim_irq_enter();
+
+    pthread_mutex_lock(&m_mutex);
+    m_tick++;
+    DWT->CYCCNT = m_tick * (SIM_HFCLK_HZ / configTICK_RATE_HZ);
+    traceTASK_INCREMENT_TICK(m_tick);
+
+    while ((m_events != NULL) && due(m_events->tick))
+    {
+        sim_event_t * ev = m_events;
+        m_events = ev->next;
+        pthread_mutex_unlock(&m_mutex);
+        ev->func(ev->argument);
+        free(ev);
+        pthread_mutex_lock(&m_mutex);
+    }
+
+    sim_timer_t * tm;
+    while ((tm = next_due_timer()) != NULL)
+    {
+        if (tm->type == osTimerPeriodic)
+        {
+            tm->deadline += tm->period;
+        }
+        else
+        {
+            tm->running = false;
+        }
+        pthread_mutex_unlock(&m_mutex);
+        tm->func(tm->argument);
+        pthread_mutex_lock(&m_mutex);
+    }
+    pthread_mutex_unlock(&m_mutex);
+
+    sim_irq_exit();
+    sim_sync();
+}
+
+// Advance to a tick, paced at speed times real time if not 0
+static void run_until (uint32_t target, uint32_t speed)
+{
+    sim_idle();
+    while ((int32_t)(target - m_tick) > 0)
+    {
+        uint32_t next = target;
+        uint32_t deadline;
+
+        pthread_mutex_lock(&m_mutex);
+        if (next_deadline(&deadline) && ((int32_t)(deadline - target) < 0))
+        {
+            next = ((int32_t)(deadline - m_tick) > 0) ? deadline : m_tick + 1;
+        }
+        if (speed > 0)
+        {
+            uint64_t ns = (uint64_t)(next - m_tick) * (1000000000UL / configTICK_RATE_HZ) / speed;
+            struct timespec delay = { .tv_sec = ns / 1000000000UL, .tv_nsec = ns % 1000000000UL };
+            pthread_mutex_unlock(&m_mutex);
+            nanosleep(&delay, NULL);
+            pthread_mutex_lock(&m_mutex);
+        }
+        // Nothing happens in between, like a tickless idle period
+        m_tick = next - 1;
+        pthread_mutex_unlock(&m_mutex);
+
+        tick();
+        sim_idle();
+    }
+}
+
+void sim_idle (void)
+{
+    pthread_mutex_lock(&m_mutex);
+    sim_thread_t * next;
+    while ((m_self == NULL) && ((next = pick()) != NULL))
+    {
+        switch_to(next, true);
+    }
+    pthread_mutex_unlock(&m_mutex);
+}
+
+void sim_start (void)
+{
+    pthread_mutex_lock(&m_mutex);
+    m_state = osKernelRunning;
+    pthread_mutex_unlock(&m_mutex);
+    sim_idle();
+}
+
+void sim_advance (uint32_t ticks)
+{
+    run_until(m_tick + ticks, 0);
+}
+
+void sim_run_until (uint32_t tick)
+{
+    run_until(tick, 0);
+}
+
+uint32_t sim_now (void)
+{
+    return __atomic_load_n(&m_tick, __ATOMIC_RELAXED);
+}
+
+void sim_at (uint32_t tick, sim_event_f func, void * argument)
+{
+    sim_event_t * ev = calloc(1, sizeof(sim_event_t));
+
+    ev->tick = tick;
+    ev->func = func;
+    ev->argument = argument;
+
+    pthread_mutex_lock(&m_mutex);
+    sim_event_t ** at = &m_events;
+    while ((*at != NULL) && ((int32_t)((*at)->tick - tick) <= 0))
+    {
+        at = &(*at)->next;
+    }
+    ev->next = *at;
+    *at = ev;
+    pthread_mutex_unlock(&m_mutex);
+}
+
+static void pin_event (void * argument)
+{
+    sim_pin_event_t * ev = argument;
+
+    sim_pin_input(ev->port, ev->pin, ev->level);
+    free(ev);
+}
+
+void sim_pin_at (uint32_t tick, uint8_t port, uint8_t pin, bool level)
+{
+    sim_pin_event_t * ev = malloc(sizeof(sim_pin_event_t));
+
+    *ev = (sim_pin_event_t){ port, pin, level };
+    sim_at(tick, pin_event, ev);
+}
+
+void sim_kernel_run (uint32_t ticks, int (*done)(void))
+{
+    m_run_ticks = ticks;
+    m_run_done = done;
+}
+
+static uint32_t env_u32 (const char * name, uint32_t fallback)
+{
+    const char * value = getenv(name);
+    return (value != NULL) ? (uint32_t)strtoul(value, NULL, 0) : fallback;
+}
+
+osStatus_t osKernelInitialize (void)
+{
+    m_state = osKernelReady;
+    return osOK;
+}
+
+osKernelState_t osKernelGetState (void)
+{
+    if ((m_state == osKernelRunning) && (m_suspended > 0))
+    {
+        return osKernelLocked;
+    }
+    return m_state;
+}
+
+osStatus_t osKernelStart (void)
+{
+    uint32_t speed = env_u32("SIM_SPEED", SIM_SPEED_DEFAULT);
+    uint32_t run = m_run_ticks;
+
+    if (m_run_done == NULL)
+    {
+        run = env_u32("SIM_RUN_MS", SIM_RUN_MS_DEFAULT) * configTICK_RATE_HZ / 1000;
+    }
+
+    sim_start();
+    run_until(run, speed);
+    if (m_suspended > 0)
+    {
+        fault("run ends with the scheduler suspended");
+    }
+    fflush(stdout);
+    if (m_run_done != NULL)
+    {
+        exit(m_run_done());
+    }
+    sim_trace_print(stdout);
+    exit(0);
+}
+
+// The CMSIS-FreeRTOS lock functions: vTaskSuspendAll() adds a suspend
+// level, xTaskResumeAll() removes one and the scheduler runs again at zero
+static void suspend_all (void)
+{
+    m_suspended++;
+}
+
+// @return true if the scheduler runs again
+static bool resume_all (void)
+{
+    if (m_suspended == 0)
+    {
+        fault("resumes the scheduler without suspending it");
+        return true;
+    }
+    m_suspended--;
+    if ((m_suspended == 0) && m_preempt)
+    {
+        preempt();
+    }
+    return m_suspended == 0;
+}
+
+int32_t osKernelLock (void)
+{
+    int32_t lock = 1;
+
+    pthread_mutex_lock(&m_mutex);
+    if (m_suspended == 0)
+    {
+        suspend_all();
+        lock = 0;
+    }
+    pthread_mutex_unlock(&m_mutex);
+    return lock;
+}
+
+int32_t osKernelUnlock (void)
+{
+    int32_t lock = 0;
+
+    pthread_mutex_lock(&m_mutex);
+    if (m_suspended > 0)
+    {
+        lock = resume_all() ? 1 : (int32_t)osError;
+    }
+    pthread_mutex_unlock(&m_mutex);
+    return lock;
+}
+
+int32_t osKernelRestoreLock (int32_t lock)
+{
+    pthread_mutex_lock(&m_mutex);
+    if (lock == 1)
+    {
+        suspend_all();
+    }
+    else if (lock != 0)
+    {
+        lock = (int32_t)osError;
+    }
+    else if (!resume_all())
+    {
+        lock = (int32_t)osError;
+    }
+    pthread_mutex_unlock(&m_mutex);
+    return lock;
+}
+
+void sim_irq_enter (void)
+{
+    pthread_mutex_lock(&m_mutex);
+    m_irq_nesting++;
+    pthread_mutex_unlock(&m_mutex);
+}
+
+void sim_irq_exit (void)
+{
+    pthread_mutex_lock(&m_mutex);
+    m_irq_nesting--;
+    if ((m_irq_nesting == 0) && (m_suspended == 0) && m_preempt)
+    {
+        preempt();
+    }
+    pthread_mutex_unlock(&m_mutex);
+}
+
+uint32_t sim_faults (void)
+{
+    return m_faults;
+}
+
+uint32_t osKernelGetTickCount (void)
+{
+    return sim_now();
+}
+
+uint32_t osKernelGetTickFreq (void)
+{
+    return configTICK_RATE_HZ;
+}
+
+osThreadId_t osThreadNew (osThreadFunc_t func, void *argument, const osThreadAttr_t *attr)
+{
+    const osThreadAttr_t none = { 0 };
+
+    attr = (attr != NULL) ? attr : &none;
+    if (!allocation(attr->cb_mem != NULL,
+                    (attr->cb_size >= sizeof(StaticTask_t)) && (attr->stack_mem != NULL) && (attr->stack_size > 0),
+                    (attr->cb_size == 0) && (attr->stack_mem == NULL)))
+    {
+        return NULL;
+    }
+
+    sim_thread_t * t = calloc(1, sizeof(sim_thread_t));
+
+    t->func = func;
+    t->argument = argument;
+    t->name = attr->name;
+    t->priority = (attr->priority != osPriorityNone) ? attr->priority : osPriorityNormal;
+    t->stack_size = (attr->stack_size > 0) ? attr->stack_size : 512;
+    t->stack_space = t->stack_size;
+    t->ready = never;
+
+    pthread_mutex_lock(&m_mutex);
+    heap_take(attr->cb_mem, sizeof(StaticTask_t));
+    heap_take(attr->stack_mem, t->stack_size);
+    sim_thread_t ** last = &m_threads;
+    while (*last != NULL)
+    {
+        last = &(*last)->next;
+    }
+    *last = t;
+    t->order = m_ready_order++;
+
+    // The new thread waits for its turn
+    if (pthread_create(&t->pthread, NULL, thread_entry, t) != 0)
+    {
+        abort();
+    }
+    preempt();
+    pthread_mutex_unlock(&m_mutex);
+    return t;
+}
+
+const char *osThreadGetName (osThreadId_t thread_id)
+{
+    return (thread_id != NULL) ? ((sim_thread_t *)thread_id)->name : NULL;
+}
+
+osThreadId_t osThreadGetId (void)
+{
+    return m_self;
+}
+
+uint32_t osThreadGetStackSize (osThreadId_t thread_id)
+{
+    return ((sim_thread_t *)thread_id)->stack_size;
+}
+
+uint32_t osThreadGetStackSpace (osThreadId_t thread_id)
+{
+    // Host stacks are not measured
+    return ((sim_thread_t *)thread_id)->stack_space;
+}
+
+void sim_stack_space (osThreadId_t thread, uint32_t space)
+{
+    ((sim_thread_t *)thread)->stack_space = space;
+}
+
+uint32_t osThreadGetCount (void)
+{
+    uint32_t count = 0;
+
+    pthread_mutex_lock(&m_mutex);
+    for (sim_thread_t * t = m_threads; t != NULL; t = t->next)
+    {
+        count += t->exited ? 0 : 1;
+    }
+    pthread_mutex_unlock(&m_mutex);
+    return count;
+}
+
+uint32_t osThreadEnumerate (osThreadId_t *thread_array, uint32_t array_items)
+{
+    uint32_t count = 0;
+
+    pthread_mutex_lock(&m_mutex);
+    for (sim_thread_t * t = m_threads; (t != NULL) && (count < array_items); t = t->next)
+    {
+        if (!t->exited)
+        {
+            thread_array[count++] = t;
+        }
+    }
+    pthread_mutex_unlock(&m_mutex);
+    return count;
+}
+
+uint32_t osThreadFlagsSet (osThreadId_t thread_id, uint32_t flags)
+{
+    sim_thread_t * t = thread_id;
+
+    if ((t == NULL) || (flags & osFlagsError))
+    {
+        return osFlagsErrorParameter;
+    }
+    pthread_mutex_lock(&m_mutex);
+    t->flags |= flags;
+    uint32_t result = t->flags;
+    preempt();
+    pthread_mutex_unlock(&m_mutex);
+    return result;
+}
+
+uint32_t osThreadFlagsClear (uint32_t flags)
+{
+    sim_thread_t * t = m_self;
+
+    if (t == NULL)
+    {
+        return osFlagsErrorISR;
+    }
+    pthread_mutex_lock(&m_mutex);
+    uint32_t result = t->flags;
+    t->flags &= ~flags;
+    pthread_mutex_unlock(&m_mutex);
+    return result;
+}
+
+static bool flags_ready (const sim_thread_t * t)
+{
+    if (t->options & osFlagsWaitAll)
+    {
+        return (t->flags & t->mask) == t->mask;
+    }
+    return (t->flags & t->mask) != 0;
+}
+
+uint32_t osThreadFlagsWait (uint32_t flags, uint32_t options, uint32_t timeout)
+{
+    sim_thread_t * t = m_self;
+    uint32_t result;
+
+    if (t == NULL)
+    {
+        return osFlagsErrorISR;
+    }
+    pthread_mutex_lock(&m_mutex);
+    t->mask = flags;
+    t->options = options;
+    if (wait(flags_ready, NULL, timeout))
+    {
+        result = t->flags;
+        if ((options & osFlagsNoClear) == 0)
+        {
+            t->flags &= ~flags;
+        }
+    }
+    else
+    {
+        result = (timeout == 0) ? osFlagsErrorResource : osFlagsErrorTimeout;
+    }
+    pthread_mutex_unlock(&m_mutex);
+    return result;
+}
+
+osStatus_t osDelay (uint32_t ticks)
+{
+    if (m_self == NULL)
+    {
+        return osErrorISR;
+    }
+    pthread_mutex_lock(&m_mutex);
+    if (ticks > 0)
+    {
+        wait(never, NULL, ticks);
+    }
+    else
+    {
+        // Yield to the ready threads of the same priority
+        sim_thread_t * next = pick();
+        if ((next != NULL) && (next->priority >= m_self->priority))
+        {
+            m_self->order = m_ready_order++;
+            switch_to(next, true);
+        }
+    }
+    pthread_mutex_unlock(&m_mutex);
+    return osOK;
+}
+
+osStatus_t osDelayUntil (uint32_t ticks)
+{
+    uint32_t delay = ticks - sim_now();
+
+    if ((delay == 0) || (delay >= 0x7FFFFFFF))
+    {
+        return osErrorParameter;
+    }
+    return osDelay(delay);
+}
+
+osTimerId_t osTimerNew (osTimerFunc_t func, osTimerType_t type, void *argument, const osTimerAttr_t *attr)
+{
+    const osTimerAttr_t none = { 0 };
+
+    attr = (attr != NULL) ? attr : &none;
+    if (!allocation(attr->cb_mem != NULL, attr->cb_size >= sizeof(StaticTimer_t), attr->cb_size == 0))
+    {
+        return NULL;
+    }
+
+    sim_timer_t * tm = calloc(1, sizeof(sim_timer_t));
+
+    tm->func = func;
+    tm->type = type;
+    tm->argument = argument;
+    tm->name = attr->name;
+
+    pthread_mutex_lock(&m_mutex);
+    heap_take(attr->cb_mem, sizeof(StaticTimer_t));
+    tm->next = m_timers;
+    m_timers = tm;
+    pthread_mutex_unlock(&m_mutex);
+    return tm;
+}
+
+osStatus_t osTimerStart (osTimerId_t timer_id, uint32_t ticks)
+{
+    sim_timer_t * tm = timer_id;
+
+    if ((tm == NULL) || (ticks == 0))
+    {
+        return osErrorParameter;
+    }
+    pthread_mutex_lock(&m_mutex);
+    tm->period = ticks;
+    tm->deadline = m_tick + ticks;
+    tm->order = m_timer_order++;
+    tm->running = true;
+    pthread_mutex_unlock(&m_mutex);
+    return osOK;
+}
+
+osStatus_t osTimerStop (osTimerId_t timer_id)
+{
+    sim_timer_t * tm = timer_id;
+    osStatus_t status = osOK;
+
+    if (tm == NULL)
+    {
+        return osErrorParameter;
+    }
+    pthread_mutex_lock(&m_mutex);
+    if (!tm->running)
+    {
+        status = osErrorResource;
+    }
+    tm->running = false;
+    pthread_mutex_unlock(&m_mutex);
+    return status;
+}
+
+uint32_t osTimerIsRunning (osTimerId_t timer_id)
+{
+    sim_timer_t * tm = timer_id;
+
+    return ((tm != NULL) && tm->running) ? 1 : 0;
+}
+
+BaseType_t xTimerChangePeriodFromISR (TimerHandle_t timer, TickType_t period, BaseType_t *woken)
+{
+    if (woken != NULL)
+    {
+        *woken = pdFALSE;
+    }
+    return (osTimerStart(timer, period) == osOK) ? pdPASS : pdFAIL;
+}
+
+osMessageQueueId_t osMessageQueueNew (uint32_t msg_count, uint32_t msg_size, const osMessageQueueAttr_t *attr)
+{
+    const osMessageQueueAttr_t none = { 0 };
+
+    attr = (attr != NULL) ? attr : &none;
+    if (!allocation(attr->cb_mem != NULL,
+                    (attr->cb_size >= sizeof(StaticQueue_t)) && (attr->mq_mem != NULL) && (attr->mq_size >= msg_count * msg_size),
+                    (attr->cb_size == 0) && (attr->mq_mem == NULL) && (attr->mq_size == 0)))
+    {
+        return NULL;
+    }
+
+    sim_queue_t * q = calloc(1, sizeof(sim_queue_t));
+
+    q->count = msg_count;
+    q->size = msg_size;
+    q->buffer = calloc(msg_count, msg_size);
+
+    pthread_mutex_lock(&m_mutex);
+    heap_take(attr->cb_mem, sizeof(StaticQueue_t));
+    heap_take(attr->mq_mem, (size_t)msg_count * msg_size);
+    pthread_mutex_unlock(&m_mutex);
+    return q;
+}
+
+static bool queue_has_space (const sim_thread_t * t)
+{
+    const sim_queue_t * q = (t != NULL) ? t->object : NULL;
+    return (q != NULL) && (q->used < q->count);
+}
+
+static bool queue_has_message (const sim_thread_t * t)
+{
+    const sim_queue_t * q = (t != NULL) ? t->object : NULL;
+    return (q != NULL) && (q->used > 0);
+}
+
+// Waits without a calling thread, from tests and handlers, only poll
+static bool queue_wait (sim_queue_t * q, sim_ready_f ready, uint32_t timeout)
+{
+    if (m_self == NULL)
+    {
+        sim_thread_t poll = { .object = q };
+        return ready(&poll);
+    }
+    m_self->object = q;
+    return wait(ready, q, timeout);
+}
+
+osStatus_t osMessageQueuePut (osMessageQueueId_t mq_id, const void *msg_ptr, uint8_t msg_prio, uint32_t timeout)
+{
+    sim_queue_t * q = mq_id;
+    osStatus_t status = osOK;
+
+    (void)msg_prio;
+    if ((q == NULL) || (msg_ptr == NULL))
+    {
+        return osErrorParameter;
+    }
+    pthread_mutex_lock(&m_mutex);
+    if (queue_wait(q, queue_has_space, timeout))
+    {
+        memcpy(&q->buffer[((q->head + q->used) % q->count) * q->size], msg_ptr, q->size);
+        q->used++;
+        preempt();
+    }
+    else
+    {
+        status = (timeout == 0) ? osErrorResource : osErrorTimeout;
+    }
+    pthread_mutex_unlock(&m_mutex);
+    return status;
+}
+
+osStatus_t osMessageQueueGet (osMessageQueueId_t mq_id, void *msg_ptr, uint8_t *msg_prio, uint32_t timeout)
+{
+    sim_queue_t * q = mq_id;
+    osStatus_t status = osOK;
+
+    if ((q == NULL) || (msg_ptr == NULL))
+    {
+        return osErrorParameter;
+    }
+    pthread_mutex_lock(&m_mutex);
+    if (queue_wait(q, queue_has_message, timeout))
+    {
+        memcpy(msg_ptr, &q->buffer[q->head * q->size], q->size);
+        q->head = (q->head + 1) % q->count;
+        q->used--;
+        if (msg_prio != NULL)
+        {
+            *msg_prio = 0;
+        }
+        preempt();
+    }
+    else
+    {
+        status = (timeout == 0) ? osErrorResource : osErrorTimeout;
+    }
+    pthread_mutex_unlock(&m_mutex);
+    return status;
+}
+
+uint32_t osMessageQueueGetCount (osMessageQueueId_t mq_id)
+{
+    sim_queue_t * q = mq_id;
+
+    return (q != NULL) ? q->used : 0;
+}
+
+size_t xPortGetFreeHeapSize (void)
+{
+    return m_heap_free;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle (void)
+{
+    return (m_current != NULL) ? m_current : &m_idle;
+}
+
+TaskHandle_t xTaskGetIdleTaskHandle (void)
+{
+    return &m_idle;
+}
+
+const char *pcTaskGetName (TaskHandle_t task)
+{
+    return ((sim_thread_t *)((task != NULL) ? task : xTaskGetCurrentTaskHandle()))->name;
+}
+
+UBaseType_t uxTaskGetSystemState (TaskStatus_t * const status, const UBaseType_t count, uint32_t * const total_run_time)
+{
+    UBaseType_t n = 0;
+
+    pthread_mutex_lock(&m_mutex);
+    for (sim_thread_t * t = m_threads; (t != NULL) && (n < count); t = t->next)
+    {
+        if (t->exited)
+        {
+            continue;
+        }
+        status[n] = (TaskStatus_t){
+            .xHandle = t,
+            .pcTaskName = t->name,
+            .xTaskNumber = n + 1,
+            .eCurrentState = (t == m_current) ? eRunning : t->blocked ? eBlocked : eReady,
+            .uxCurrentPriority = t->priority,
+            .uxBasePriority = t->priority,
+            .usStackHighWaterMark = (uint16_t)(t->stack_space / sizeof(StackType_t)),
+        };
+        n++;
+    }
+    if (n < count)
+    {
+        status[n++] = (TaskStatus_t){ .xHandle = &m_idle, .pcTaskName = m_idle.name, .eCurrentState = eReady };
+    }
+    pthread_mutex_unlock(&m_mutex);
+
+    if (total_run_time != NULL)
+    {
+        *total_run_time = 0;
+    }
+    return n;
+}
+
+void vTaskStepTick (const TickType_t ticks)
+{
+    (void)ticks;
+}
+
+eSleepModeStatus eTaskConfirmSleepModeStatus (void)
+{
+    return eAbortSleep;
+}
+
+void EMU_EnterEM1 (void)
+{
+}
+
+void EMU_EnterEM2 (bool restore)
+{
+    (void)restore;
+}
+
+uint32_t RTCC_CounterGet (void)
+{
+    return (uint32_t)((uint64_t)sim_now() * 32768 / configTICK_RATE_HZ);
+}
@@ -0,0 +1,155 @@
+/**
+ * @brief Host platform: logging to stdout with the simulated time, the
+ * application image the CRC is computed over and the embedded header.
+ *
+ * The image is a fixed pseudo-random pattern with the linker script
+ * symbols pointing into it. The header is built from the documented
+ * appheader_t layout with the version from the Makefile, not by HEADEREDIT,
+ * and copied into the image after the vector table. Its CRC is computed
+ * here with a bitwise CRC-16/CCITT over the image without the header.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include "sim.h"
+
+#include <stdarg.h>
+#include <string.h>
+#include <inttypes.h>
+#include <pthread.h>
+
+#include "log.h"
+#include "logger_fwrite.h"
+#include "platform.h"
+#include "retargetserial.h"
+#include "em_device.h"
+
+#include "appheader.h"
+#include "imagecrc.h"
+
+#define SIM_LOG_MAX    160
+#define SIM_TEXT_SIZE  4096
+#define SIM_DATA_SIZE  256
+#define SIM_HEADER_AT  256
+
+// Image bytes, xorshift32 from a fixed seed
+#define SIM_X1(x) ((x) ^ ((x) << 13))
+#define SIM_X2(x) ((x) ^ ((x) >> 17))
+#define SIM_X3(x) ((x) ^ ((x) << 5))
+
+#define SIM_STR_(x) #x
+#define SIM_STR(x)  SIM_STR_(x)
+
+static pthread_mutex_t m_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uint16_t m_log_level;
+static log_writer_f m_writer;
+
+uint8_t sim_image[SIM_TEXT_SIZE + SIM_DATA_SIZE];
+
+__asm__(".globl __etext\n.set __etext, sim_image + " SIM_STR(SIM_TEXT_SIZE) "\n"
+        ".globl __data_start__\n.set __data_start__, sim_image + " SIM_STR(SIM_TEXT_SIZE) "\n"
+        ".globl __data_end__\n.set __data_end__, sim_image + " SIM_STR(SIM_TEXT_SIZE + SIM_DATA_SIZE) "\n"
+        ".globl gHeaderData\n.set gHeaderData, sim_image + " SIM_STR(SIM_HEADER_AT) "\n");
+
+static const appheader_t m_header = {
+    .header_version = 1,
+    .softtype = 1,
+    .header_size = sizeof(appheader_t),
+    .firmaddr = 0,
+    .firmsizemax = SIM_TEXT_SIZE + SIM_DATA_SIZE,
+    .size = SIM_TEXT_SIZE + SIM_DATA_SIZE,
+    .versionbin = { VERSION_MAJOR, VERSION_MINOR, VERSION_PATCH, 0 },
+    .version = VERSION_STR,
+    .timestamp = 1640995200,
+    .name = "esw-gpio",
+};
+const unsigned int gHeaderSize = sizeof(appheader_t);
+
+static uint16_t image_crc (uint16_t crc, const uint8_t * p, uint32_t len)
+{
+    while (len--)
+    {
+        crc ^= (uint16_t)(*p++) << 8;
+        for (uint8_t b = 0; b < 8; b++)
+        {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+__attribute__((constructor)) static void image_init (void)
+{
+    appheader_t * header = (appheader_t *)&sim_image[SIM_HEADER_AT];
+    uint32_t tail = SIM_HEADER_AT + sizeof(appheader_t);
+    uint32_t x = 0x2545F491;
+
+    for (uint32_t i = 0; i < sizeof(sim_image); i++)
+    {
+        x = SIM_X3(SIM_X2(SIM_X1(x)));
+        sim_image[i] = (uint8_t)x;
+    }
+
+    memcpy(header, &m_header, sizeof(appheader_t));
+    uint16_t crc = image_crc(IMAGECRC_INIT, sim_image, SIM_HEADER_AT);
+    header->crc = image_crc(crc, &sim_image[tail], sizeof(sim_image) - tail);
+}
+
+static int stdout_write (const char *ptr, int len)
+{
+    return (int)fwrite(ptr, 1, (size_t)len, stdout);
+}
+
+void log_init (uint16_t level, log_writer_f writer, void *arg)
+{
+    (void)arg;
+    m_log_level = level;
+    m_writer = writer;
+}
+
+void log_write (uint16_t flag, const char *module, const char *fmt, ...)
+{
+    char buf[SIM_LOG_MAX];
+    char level = (flag >= LOG_ERR1) ? 'E' : (flag >= LOG_WARN1) ? 'W' : (flag >= LOG_INFO1) ? 'I' : 'D';
+    va_list args;
+
+    if ((m_log_level & flag) == 0)
+    {
+        return;
+    }
+
+    int len = snprintf(buf, sizeof(buf), "%08"PRIu32" %c|%s:", sim_now(), level, module);
+    va_start(args, fmt);
+    len += vsnprintf(&buf[len], sizeof(buf) - (size_t)len, fmt, args);
+    va_end(args);
+    if (len > (int)sizeof(buf) - 3)
+    {
+        len = (int)sizeof(buf) - 3;
+    }
+    memcpy(&buf[len], "\r\n", 3);
+    len += 2;
+
+    (m_writer != NULL ? m_writer : stdout_write)(buf, len);
+}
+
+void logger_fwrite_init (void)
+{
+}
+
+int logger_fwrite (const char *ptr, int len)
+{
+    pthread_mutex_lock(&m_mutex);
+    int written = stdout_write(ptr, len);
+    fflush(stdout);
+    pthread_mutex_unlock(&m_mutex);
+    return written;
+}
+
+void PLATFORM_Init (void)
+{
+    setvbuf(stdout, NULL, _IOLBF, 0);
+}
+
+void RETARGET_SerialInit (void)
+{
+}
@@ -0,0 +1,151 @@
+/**
+ * @brief Application regression test: main() runs for two simulated hours
+ * with button presses injected at exact ticks, the LED and buzzer pin
+ * changes are checked against the expected ones. The log output and the
+ * trace digest are printed, make host compares two runs for equality.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include "test.h"
+#include "sim.h"
+
+#include <inttypes.h>
+
+#include "cmsis_os2.h"
+#include "em_gpio.h"
+
+#include "pins.h"
+#include "button.h"
+
+#define RUN_TICKS (2 * 3600 * 1000)
+#define BLINK_MS  500
+
+// hp, buzzer_tone, gpioint and log, created in the given memory
+#ifdef LOGGER_RING
+#define APP_THREADS 4
+#else
+#define APP_THREADS 3
+#endif//LOGGER_RING
+
+// Ticks where the siren starts: press, 20ms debounce, 100ms hold, 20ms
+// debounce, BUTTON_DOUBLE_MS without a second press
+#define SHORT_PRESS_1 5000
+#define SHORT_PRESS_2 (RUN_TICKS - 10000)
+#define SIREN_DELAY   (120 + BUTTON_DOUBLE_MS)
+
+int app_main (void);
+
+typedef struct
+{
+    uint32_t tick;
+    uint32_t hz;
+} tone_t;
+
+// Press the button for a time with contact bounce, the button is active low
+static void press (uint32_t tick, uint32_t ms)
+{
+    uint8_t port = PIN_PORT(PIN_BUTTON);
+    uint8_t pin = PIN_NUM(PIN_BUTTON);
+
+    sim_pin_at(tick, port, pin, false);
+    sim_pin_at(tick + 2, port, pin, true);
+    sim_pin_at(tick + 3, port, pin, false);
+    sim_pin_at(tick + ms, port, pin, true);
+    sim_pin_at(tick + ms + 2, port, pin, false);
+    sim_pin_at(tick + ms + 3, port, pin, true);
+}
+
+static void check_green (void)
+{
+    uint32_t count = 0;
+    uint32_t last = 0;
+
+    for (uint32_t i = 0; i < sim_trace_count(); i++)
+    {
+        const sim_trace_t * t = sim_trace_get(i);
+        if ((t->port != PIN_PORT(PIN_LED_GREEN)) || (t->pin != PIN_NUM(PIN_LED_GREEN)) || (t->tick == 0))
+        {
+            continue;
+        }
+        if (count > 0)
+        {
+            TEST_EQUAL(t->tick - last, BLINK_MS);
+        }
+        last = t->tick;
+        count++;
+    }
+    TEST_EQUAL(count, RUN_TICKS / BLINK_MS);
+}
+
+static void check_buzzer (void)
+{
+    static const tone_t expected[] = {
+        { SHORT_PRESS_1 + SIREN_DELAY, 500 },
+        { SHORT_PRESS_1 + SIREN_DELAY + 200, 0 },
+        { SHORT_PRESS_1 + SIREN_DELAY + 250, 250 },
+        { SHORT_PRESS_1 + SIREN_DELAY + 450, 0 },
+        { SHORT_PRESS_2 + SIREN_DELAY, 500 },
+        { SHORT_PRESS_2 + SIREN_DELAY + 200, 0 },
+        { SHORT_PRESS_2 + SIREN_DELAY + 250, 250 },
+        { SHORT_PRESS_2 + SIREN_DELAY + 450, 0 },
+    };
+    uint32_t count = 0;
+
+    for (uint32_t i = 0; i < sim_trace_count(); i++)
+    {
+        const sim_trace_t * t = sim_trace_get(i);
+        if ((t->port != PIN_PORT(PIN_BUZZER)) || (t->pin != PIN_NUM(PIN_BUZZER)) || (t->tick == 0))
+        {
+            continue;
+        }
+        if (count < sizeof(expected) / sizeof(expected[0]))
+        {
+            TEST_EQUAL(t->tick, expected[count].tick);
+            TEST_EQUAL(t->hz, expected[count].hz);
+        }
+        count++;
+    }
+    TEST_EQUAL(count, sizeof(expected) / sizeof(expected[0]));
+}
+
+// FNV-1a over the whole pin trace
+static uint32_t trace_digest (void)
+{
+    uint32_t hash = 2166136261UL;
+
+    for (uint32_t i = 0; i < sim_trace_count(); i++)
+    {
+        const sim_trace_t * t = sim_trace_get(i);
+        const uint32_t fields[] = { t->tick, t->port, t->pin, t->level, t->duty, t->hz };
+        for (uint32_t f = 0; f < sizeof(fields) / sizeof(fields[0]); f++)
+        {
+            hash = (hash ^ fields[f]) * 16777619UL;
+        }
+    }
+    return hash;
+}
+
+static int done (void)
+{
+    check_green();
+    check_buzzer();
+    // Also counts a run ending with the scheduler suspended
+    TEST_EQUAL(sim_faults(), 0);
+    TEST_EQUAL(osThreadGetCount(), APP_THREADS);
+    printf("trace %"PRIu32" changes, digest %08"PRIX32"\n", sim_trace_count(), trace_digest());
+    return TEST_RESULT();
+}
+
+int main (void)
+{
+    press(SHORT_PRESS_1, 100);
+    // A double click queries the state, a long press stops a silent siren
+    press(3600000, 100);
+    press(3600200, 100);
+    press(5000000, 1600);
+    press(SHORT_PRESS_2, 100);
+
+    sim_kernel_run(RUN_TICKS, done);
+    return app_main();
+}
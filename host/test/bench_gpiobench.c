@@ -0,0 +1,103 @@
+/**
+ * @brief The GPIO primitive benchmark of GPIOBENCH=1 on the simulator. The
+ * simulated cycle counter follows the kernel tick, so the cycle table is
+ * zero here; the run checks that every primitive is measured at each
+ * optimization level, that the primitives drive the green LED pin as
+ * expected and prints the host time of the whole run.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include "test.h"
+#include "sim.h"
+
+#include <string.h>
+#include <time.h>
+#include <inttypes.h>
+
+#include "pins.h"
+#include "board.h"
+#include "gpiobench.h"
+#include "log.h"
+
+static const char * const m_labels[] = {
+    "loop", "GPIO_PinOutToggle", "GPIO_PinOutSet", "GPIO_PinInGet", "GPIO_PortOutSetVal",
+    "DOUTTGL write", "bit-band write", "BITSET alias write", "DOUT read-modify-write",
+    "pin_set", "pin_clear", "pin_toggle", "pin_get"
+};
+
+#define LABEL_COUNT (sizeof(m_labels) / sizeof(m_labels[0]))
+
+static char m_log[4096];
+static uint32_t m_log_len;
+
+static int capture (const char *ptr, int len)
+{
+    if (m_log_len + (uint32_t)len < sizeof(m_log))
+    {
+        memcpy(&m_log[m_log_len], ptr, (size_t)len);
+        m_log_len += (uint32_t)len;
+        m_log[m_log_len] = '\0';
+    }
+    return len;
+}
+
+// A table row, the label followed by the three optimization levels
+static bool row (const char * label)
+{
+    char prefix[40];
+
+    snprintf(prefix, sizeof(prefix), "|bench:%-24s ", label);
+    const char * at = strstr(m_log, prefix);
+    unsigned o0, os, o2;
+    return (at != NULL) && (sscanf(at + strlen(prefix), "%u %u %u", &o0, &os, &o2) == 3);
+}
+
+static double now_ms (void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000.0 + t.tv_nsec / 1000000.0;
+}
+
+int main (void)
+{
+    log_init(0xFFFF, capture, NULL);
+    board_init();
+    sim_start();
+    sim_trace_clear();
+
+    double start = now_ms();
+    gpiobench_run();
+    double ms = now_ms() - start;
+
+    for (uint32_t i = 0; i < LABEL_COUNT; i++)
+    {
+        if (!row(m_labels[i]))
+        {
+            fprintf(stderr, "no row for %s\n", m_labels[i]);
+            test_failures++;
+        }
+    }
+
+    // GPIO_PinOutToggle runs 3 times per level and changes the pin on every
+    // call. The direct DOUTTGL stores of "DOUTTGL write" and pin_toggle are
+    // seen as one toggle each, at the bit-band write and the final clear,
+    // which then set and clear the pin. GPIO_PinOutSet and pin_clear change
+    // it once, the others write the level it already has.
+    uint32_t changes = 0;
+    for (uint32_t i = 0; i < sim_trace_count(); i++)
+    {
+        const sim_trace_t * t = sim_trace_get(i);
+        if ((t->port == PIN_PORT(PIN_LED_GREEN)) && (t->pin == PIN_NUM(PIN_LED_GREEN)))
+        {
+            changes++;
+        }
+    }
+    TEST_EQUAL(changes, GPIOBENCH_ITERATIONS * 3 * 3 + 1 + 2 + 1 + 2);
+    TEST_EQUAL(sim_pin(PIN_PORT(PIN_LED_GREEN), PIN_NUM(PIN_LED_GREEN))->level, 0);
+
+    printf("gpiobench %"PRIu32" pin changes, %.1f ms on the host\n", changes, ms);
+    return TEST_RESULT();
+}
@@ -0,0 +1,67 @@
+/**
+ * @brief GPIO interrupt dispatch throughput on the host, dispatches and
+ * callbacks per second for masks with 1, 2, 4, 8 and 16 interrupts
+ * pending. The cost follows the pending interrupts, not the registered.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include "test.h"
+#include "sim.h"
+
+#include <time.h>
+
+#include "gpioint.h"
+
+#define BENCH_MS 100 // Minimum measuring time per mask
+
+static uint32_t m_calls;
+
+static void callback (uint8_t intno, void * arg)
+{
+    m_calls++;
+}
+
+static double now_ms (void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000.0 + t.tv_nsec / 1000000.0;
+}
+
+int main (void)
+{
+    static const uint32_t masks[] = { 0x0001, 0x0101, 0x1111, 0x5555, 0xFFFF };
+
+    gpioint_init(NULL);
+    for (uint8_t i = 0; i < GPIOINT_COUNT; i++)
+    {
+        TEST_CHECK(gpioint_register(i, callback, NULL, false));
+    }
+
+    for (uint32_t m = 0; m < sizeof(masks) / sizeof(masks[0]); m++)
+    {
+        uint32_t dispatches = 0;
+        double start = now_ms();
+        double ms;
+
+        m_calls = 0;
+        do
+        {
+            for (uint32_t i = 0; i < 1000; i++)
+            {
+                gpioint_dispatch(masks[m]);
+            }
+            dispatches += 1000;
+            ms = now_ms() - start;
+        } while (ms < BENCH_MS);
+
+        TEST_EQUAL(m_calls, dispatches * __builtin_popcount(masks[m]));
+        printf("gpioint %2d pending: %6.1f ns per dispatch, %5.1f ns per callback, %.1f M callbacks/s\n",
+               __builtin_popcount(masks[m]), ms * 1000000.0 / dispatches,
+               ms * 1000000.0 / m_calls, m_calls / ms / 1000.0);
+    }
+
+    return TEST_RESULT();
+}
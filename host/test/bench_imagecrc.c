@@ -0,0 +1,87 @@
+/**
+ * @brief Software image CRC methods on the host, MB/s of the bitwise,
+ * table, slice-by-4 and slice-by-8 CRC over the same data. All methods
+ * must give the bitwise result.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include "test.h"
+#include "sim.h"
+
+#include <stdlib.h>
+#include <time.h>
+#include <inttypes.h>
+
+#include "imagecrc.h"
+
+#define BENCH_LEN   (256 * 1024)
+#define BENCH_MS    100 // Minimum measuring time per method
+
+static const struct
+{
+    imagecrc_method_t method;
+    const char * name;
+} m_methods[] = {
+    { IMAGECRC_BITWISE, "bitwise" },
+    { IMAGECRC_TABLE,   "table" },
+    { IMAGECRC_SLICE4,  "slice-by-4" },
+    { IMAGECRC_SLICE8,  "slice-by-8" },
+};
+
+#define METHOD_COUNT (sizeof(m_methods) / sizeof(m_methods[0]))
+
+static double now_ms (void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000.0 + t.tv_nsec / 1000000.0;
+}
+
+int main (void)
+{
+    static uint8_t data[BENCH_LEN];
+    static const uint32_t lengths[] = { 0, 1, 3, 4, 5, 7, 8, 9, 63, 1001 };
+    uint32_t x = 1;
+
+    for (uint32_t i = 0; i < sizeof(data); i++)
+    {
+        x = x * 1103515245 + 12345;
+        data[i] = (uint8_t)(x >> 16);
+    }
+
+    // Every length modulo the slice widths, from an odd address
+    for (uint32_t m = 0; m < METHOD_COUNT; m++)
+    {
+        TEST_EQUAL(imagecrc_compute_method(m_methods[m].method, "123456789", 9), 0x29B1);
+        for (uint32_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++)
+        {
+            TEST_EQUAL(imagecrc_compute_method(m_methods[m].method, &data[1], lengths[l]),
+                       imagecrc_compute_method(IMAGECRC_BITWISE, &data[1], lengths[l]));
+        }
+    }
+
+    uint16_t reference = imagecrc_compute_method(IMAGECRC_BITWISE, data, sizeof(data));
+    for (uint32_t m = 0; m < METHOD_COUNT; m++)
+    {
+        uint32_t rounds = 0;
+        uint16_t crc = 0;
+        double start = now_ms();
+        double elapsed;
+
+        do
+        {
+            crc = imagecrc_compute_method(m_methods[m].method, data, sizeof(data));
+            rounds++;
+            elapsed = now_ms() - start;
+        }
+        while (elapsed < BENCH_MS);
+
+        TEST_EQUAL(crc, reference);
+        printf("%-12s %8.1f MB/s\n", m_methods[m].name,
+               (double)rounds * sizeof(data) / (1024.0 * 1024.0) / (elapsed / 1000.0));
+    }
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,123 @@
+/**
+ * @brief LED register writes per frame, the port-batched driver against
+ * toggling pin by pin. The same random RGB frames are applied both ways
+ * and the writes are counted from the pin trace, the changes that one
+ * register write made share their sim_trace_t sync number.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include "test.h"
+#include "sim.h"
+
+#include "em_gpio.h"
+
+#include "board.h"
+#include "leds.h"
+#include "pins.h"
+
+#define FRAMES 1000
+
+static const struct
+{
+    GPIO_Port_TypeDef port;
+    uint8_t pin;
+} m_pins[LEDS_COUNT] = { { PIN_LED_RED }, { PIN_LED_GREEN }, { PIN_LED_BLUE } };
+
+static uint8_t m_frames[FRAMES];
+
+typedef struct
+{
+    uint32_t changes; // Pin changes
+    uint32_t writes;  // Register writes that changed pins
+} count_t;
+
+static count_t count (void)
+{
+    count_t c = { 0, 0 };
+    const sim_trace_t * last = NULL;
+
+    for (uint32_t i = 0; i < sim_trace_count(); i++)
+    {
+        const sim_trace_t * t = sim_trace_get(i);
+        if ((last == NULL) || (t->sync != last->sync) || (t->port != last->port))
+        {
+            c.writes++;
+        }
+        c.changes++;
+        last = t;
+    }
+    return c;
+}
+
+// Ports that one frame changes after another
+static uint32_t ports_changed (uint8_t from, uint8_t to)
+{
+    uint32_t ports = 0;
+
+    for (uint8_t i = 0; i < LEDS_COUNT; i++)
+    {
+        if ((from ^ to) & (1 << i))
+        {
+            ports |= 1UL << m_pins[i].port;
+        }
+    }
+    return __builtin_popcount(ports);
+}
+
+int main (void)
+{
+    uint32_t x = 1;
+    uint32_t expected_writes = 0;
+    uint32_t expected_changes = 0;
+    uint8_t last = 0;
+
+    board_init();
+    leds_init();
+    sim_start();
+
+    for (uint32_t f = 0; f < FRAMES; f++)
+    {
+        x = x * 1103515245 + 12345;
+        m_frames[f] = (x >> 16) & LEDS_ALL;
+        expected_writes += ports_changed(last, m_frames[f]);
+        expected_changes += __builtin_popcount(last ^ m_frames[f]);
+        last = m_frames[f];
+    }
+
+    // One write per changed port, the LEDs of a port change together
+    leds_set(0);
+    sim_trace_clear();
+    for (uint32_t f = 0; f < FRAMES; f++)
+    {
+        leds_set(m_frames[f]);
+    }
+    count_t batched = count();
+    TEST_EQUAL(batched.changes, expected_changes);
+    TEST_EQUAL(batched.writes, expected_writes);
+
+    // One write per changed pin
+    leds_set(0);
+    sim_trace_clear();
+    last = 0;
+    for (uint32_t f = 0; f < FRAMES; f++)
+    {
+        for (uint8_t i = 0; i < LEDS_COUNT; i++)
+        {
+            if ((last ^ m_frames[f]) & (1 << i))
+            {
+                GPIO_PinOutToggle(m_pins[i].port, m_pins[i].pin);
+            }
+        }
+        last = m_frames[f];
+    }
+    count_t per_pin = count();
+    TEST_EQUAL(per_pin.changes, expected_changes);
+    TEST_EQUAL(per_pin.writes, expected_changes);
+
+    printf("leds %u frames, %.2f pin changes per frame: %.2f writes per frame batched by port, %.2f pin by pin\n",
+           FRAMES, (double)expected_changes / FRAMES,
+           (double)batched.writes / FRAMES, (double)per_pin.writes / FRAMES);
+
+    return TEST_RESULT();
+}
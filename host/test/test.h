@@ -0,0 +1,36 @@
+/**
+ * @brief Minimal checks for the host tests, a failed check is reported
+ * and the test continues, TEST_RESULT() gives the exit status.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef TEST_H_
+#define TEST_H_
+
+#include <stdio.h>
+
+static int test_failures;
+
+#define TEST_CHECK(cond) do { \
+    if (!(cond)) \
+    { \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        test_failures++; \
+    } \
+} while (0)
+
+#define TEST_EQUAL(actual, expected) do { \
+    long long _actual = (long long)(actual); \
+    long long _expected = (long long)(expected); \
+    if (_actual != _expected) \
+    { \
+        fprintf(stderr, "%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, _actual, _expected); \
+        test_failures++; \
+    } \
+} while (0)
+
+#define TEST_RESULT() (fprintf(stderr, "%s: %s\n", __FILE__, (test_failures == 0) ? "pass" : "FAIL"), \
+                       (test_failures == 0) ? 0 : 1)
+
+#endif//TEST_H_
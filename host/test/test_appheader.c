@@ -0,0 +1,203 @@
+/**
+ * @brief Application header parsing and the appheader_check tool. The
+ * embedded header of the host build is a fixture written from the
+ * appheader_t layout, see host/sim_platform.c, so these tests do not show
+ * that the layout matches HEADEREDIT. The firmware build does that, it
+ * runs appheader_check on its header.bin with the HEADEREDIT values.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include "test.h"
+#include "sim.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "appheader.h"
+#include "imagecrc.h"
+
+static void test_parse (void)
+{
+    appheader_t h = {
+        .header_version = 1,
+        .header_size = sizeof(appheader_t),
+        .version = "2.3.4",
+        .name = "test",
+    };
+
+    TEST_CHECK(appheader_parse(&h, sizeof(h)) == &h);
+    TEST_CHECK(appheader_parse(NULL, sizeof(h)) == NULL);
+    TEST_CHECK(appheader_parse(&h, sizeof(h) - 1) == NULL);
+
+    // The size field must match the embedded size
+    h.header_size = sizeof(h) + 4;
+    TEST_CHECK(appheader_parse(&h, sizeof(h)) == NULL);
+    h.header_size = sizeof(h);
+
+    memset(h.version, '1', sizeof(h.version));
+    TEST_CHECK(appheader_parse(&h, sizeof(h)) == NULL);
+    strcpy(h.version, "2.3.4");
+
+    memset(h.name, 'n', sizeof(h.name));
+    TEST_CHECK(appheader_parse(&h, sizeof(h)) == NULL);
+}
+
+static void test_embedded (void)
+{
+    const appheader_t * h = appheader_get();
+    const appheader_version_t * v = appheader_version();
+
+    TEST_CHECK(h != NULL);
+    if (h != NULL)
+    {
+        TEST_CHECK(strcmp(h->name, "esw-gpio") == 0);
+        TEST_CHECK(strcmp(h->version, VERSION_STR) == 0);
+    }
+    TEST_EQUAL(v->major, VERSION_MAJOR);
+    TEST_EQUAL(v->minor, VERSION_MINOR);
+    TEST_EQUAL(v->patch, VERSION_PATCH);
+    TEST_CHECK(strcmp(v->str, VERSION_STR) == 0);
+}
+
+int appheader_check_main (int argc, char * argv[]);
+
+static void write_file (const char * path, const void * data, size_t len)
+{
+    FILE * f = fopen(path, "wb");
+
+    TEST_CHECK(f != NULL);
+    if (f != NULL)
+    {
+        fwrite(data, 1, len, f);
+        fclose(f);
+    }
+}
+
+static int check (const char * a1, const char * a2, const char * a3, const char * a4)
+{
+    char * argv[] = { "appheader_check", (char *)a1, (char *)a2, (char *)a3, (char *)a4, NULL };
+    int argc = 1;
+
+    while (argv[argc] != NULL)
+    {
+        argc++;
+    }
+    return appheader_check_main(argc, argv);
+}
+
+// The tool mechanics on written files, the layout itself is checked by the
+// firmware build on the header.bin that HEADEREDIT writes
+static void test_check_tool (void)
+{
+    static const uint8_t uuid[APPHEADER_UUID_LEN] = {
+        0xd7, 0x09, 0xe1, 0xc5, 0x49, 0x6a, 0x4d, 0x31, 0x89, 0x57, 0xf3, 0x89, 0xd7, 0xfd, 0xbb, 0x71
+    };
+    appheader_t h = {
+        .header_version = 1,
+        .softtype = 1,
+        .header_size = sizeof(appheader_t),
+        .firmaddr = 0x4000,
+        .versionbin = { 1, 2, 3, 0 },
+        .version = "1.2.3-dev",
+        .timestamp = 1640995200,
+        .name = "esw-gpio",
+    };
+    char a[] = "/tmp/test_appheader_a_XXXXXX";
+    char b[] = "/tmp/test_appheader_b_XXXXXX";
+
+    memcpy(h.uuid_application, uuid, sizeof(uuid));
+    TEST_CHECK(mkstemp(a) >= 0);
+    TEST_CHECK(mkstemp(b) >= 0);
+    write_file(a, &h, sizeof(h));
+
+    TEST_EQUAL(check(a, NULL, NULL, NULL), 0);
+    TEST_EQUAL(check("-e", "name=esw-gpio", a, NULL), 0);
+    TEST_EQUAL(check("-e", "firmaddr=0x4000", a, NULL), 0);
+    TEST_EQUAL(check("-e", "versionbin=010203", a, NULL), 0);
+    TEST_EQUAL(check("-e", "uuid3=d709e1c5-496a-4d31-8957-f389d7fdbb71", a, NULL), 0);
+    TEST_EQUAL(check("-e", "version=1.2.3-dev", a, NULL), 0);
+
+    TEST_EQUAL(check("-e", "name=esw", a, NULL), 1);
+    TEST_EQUAL(check("-e", "timestamp=1", a, NULL), 1);
+    TEST_EQUAL(check("-e", "versionbin=0102", a, NULL), 1);
+    TEST_EQUAL(check("-e", "uuid2=d709e1c5", a, NULL), 1);
+    TEST_EQUAL(check("-e", "colour=red", a, NULL), 2);
+    TEST_EQUAL(check("-x", a, NULL, NULL), 2);
+
+    // Diff of two files
+    write_file(b, &h, sizeof(h));
+    TEST_EQUAL(check(a, b, NULL, NULL), 0);
+    h.timestamp++;
+    write_file(b, &h, sizeof(h));
+    TEST_EQUAL(check(a, b, NULL, NULL), 1);
+
+    // A file of another size is not a header
+    write_file(b, &h, sizeof(h) - 4);
+    TEST_EQUAL(check(b, NULL, NULL, NULL), 1);
+
+    remove(a);
+    remove(b);
+}
+
+// Image mode: the header is found by its bytes, the stamped size and CRC
+// are checked against the image without the header
+static void test_check_image (void)
+{
+    static uint8_t image[1024];
+    appheader_t h = {
+        .header_version = 1,
+        .header_size = sizeof(appheader_t),
+        .version = "1.0.0",
+        .name = "esw-gpio",
+    };
+    appheader_t * stamped = (appheader_t *)&image[200];
+    char a[] = "/tmp/test_appheader_h_XXXXXX";
+    char b[] = "/tmp/test_appheader_i_XXXXXX";
+
+    TEST_CHECK(mkstemp(a) >= 0);
+    TEST_CHECK(mkstemp(b) >= 0);
+    write_file(a, &h, sizeof(h));
+
+    for (uint32_t i = 0; i < sizeof(image); i++)
+    {
+        image[i] = (uint8_t)(i * 7 + 3);
+    }
+    memcpy(stamped, &h, sizeof(h));
+    stamped->size = sizeof(image);
+    stamped->crc = imagecrc_compute_skip(image, sizeof(image), stamped, sizeof(appheader_t));
+    write_file(b, image, sizeof(image));
+    TEST_EQUAL(check("-i", b, a, NULL), 0);
+
+    stamped->crc ^= 1;
+    write_file(b, image, sizeof(image));
+    TEST_EQUAL(check("-i", b, a, NULL), 1);
+    stamped->crc ^= 1;
+
+    stamped->size--;
+    write_file(b, image, sizeof(image));
+    TEST_EQUAL(check("-i", b, a, NULL), 1);
+    stamped->size++;
+
+    // Not in the image, or in it twice
+    stamped->timestamp = 1;
+    write_file(b, image, sizeof(image));
+    TEST_EQUAL(check("-i", b, a, NULL), 1);
+    stamped->timestamp = 0;
+    memcpy(&image[600], stamped, sizeof(appheader_t));
+    write_file(b, image, sizeof(image));
+    TEST_EQUAL(check("-i", b, a, NULL), 1);
+
+    remove(a);
+    remove(b);
+}
+
+int main (void)
+{
+    test_check_tool();
+    test_check_image();
+    test_parse();
+    test_embedded();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,88 @@
+/**
+ * @brief Binary log record encoding. The format strings are in an
+ * allocated section on the host, the recorded addresses are read back
+ * directly.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include "test.h"
+#include "sim.h"
+
+#include <string.h>
+
+#define __MODUUL__ "test"
+#include "binlog.h"
+
+static uint8_t m_buf[256];
+static int m_len;
+
+static int sink (const char *ptr, int len)
+{
+    memcpy(m_buf, ptr, len);
+    m_len = len;
+    return len;
+}
+
+static uint32_t get32 (const uint8_t * p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static const char * format (void)
+{
+    return (const char *)(uintptr_t)get32(&m_buf[2]);
+}
+
+static void test_text (void)
+{
+    char text[200];
+
+    TEST_EQUAL(logger_binlog("hello\r\n", 7), 7);
+    TEST_EQUAL(m_len, 2 + 7);
+    TEST_EQUAL(m_buf[0], BINLOG_TEXT);
+    TEST_EQUAL(m_buf[1], 7);
+    TEST_CHECK(memcmp(&m_buf[2], "hello\r\n", 7) == 0);
+
+    memset(text, 'x', sizeof(text));
+    TEST_EQUAL(logger_binlog(text, sizeof(text)), sizeof(text));
+    TEST_EQUAL(m_len, 2 + BINLOG_TEXT_MAX);
+    TEST_EQUAL(m_buf[1], BINLOG_TEXT_MAX);
+}
+
+static void test_records (void)
+{
+    binfo1("started");
+    TEST_EQUAL(m_len, 10);
+    TEST_EQUAL(m_buf[0], BINLOG_RECORD);
+    TEST_EQUAL(m_buf[1], 0);
+    TEST_CHECK(strcmp(format(), "I|test|started") == 0);
+    TEST_EQUAL(get32(&m_buf[6]), 0);
+
+    sim_advance(1234);
+    bwarn1("value %u", 42);
+    TEST_EQUAL(m_len, 14);
+    TEST_EQUAL(m_buf[1], 1);
+    TEST_CHECK(strcmp(format(), "W|test|value %u") == 0);
+    TEST_EQUAL(get32(&m_buf[6]), 1234);
+    TEST_EQUAL(get32(&m_buf[10]), 42);
+
+    binfo1("%u %u %u %u", 1, 2, 0xFFFFFFFF, 4);
+    TEST_EQUAL(m_len, 10 + 4 * BINLOG_ARGS_MAX);
+    TEST_EQUAL(m_buf[1], 4);
+    TEST_EQUAL(get32(&m_buf[10]), 1);
+    TEST_EQUAL(get32(&m_buf[14]), 2);
+    TEST_EQUAL(get32(&m_buf[18]), 0xFFFFFFFF);
+    TEST_EQUAL(get32(&m_buf[22]), 4);
+}
+
+int main (void)
+{
+    binlog_init(sink);
+    sim_start();
+
+    test_text();
+    test_records();
+
+    return TEST_RESULT();
+}
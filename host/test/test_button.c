@@ -0,0 +1,160 @@
+/**
+ * @brief Button debouncing and press classification with bouncing edges
+ * injected on the simulated PF4.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include "test.h"
+#include "sim.h"
+
+#include "em_gpio.h"
+
+#include "board.h"
+#include "gpioint.h"
+#include "button.h"
+#include "latency.h"
+
+#define EVENTS_MAX 16
+
+typedef struct
+{
+    button_event_t event;
+    uint32_t tick;
+} event_t;
+
+static event_t m_events[EVENTS_MAX];
+static uint32_t m_count;
+
+static void button_event (button_event_t event)
+{
+    if (m_count < EVENTS_MAX)
+    {
+        m_events[m_count] = (event_t){ event, sim_now() };
+    }
+    m_count++;
+}
+
+// Change the button state with contact bounce, the button is active low
+static void bounce (bool pressed)
+{
+    sim_pin_input(gpioPortF, 4, !pressed);
+    sim_advance(2);
+    sim_pin_input(gpioPortF, 4, pressed);
+    sim_advance(1);
+    sim_pin_input(gpioPortF, 4, !pressed);
+}
+
+// Run until a tick relative to start
+static void until (uint32_t start, uint32_t tick)
+{
+    sim_advance(start + tick - sim_now());
+}
+
+static void check_events (const event_t expected[], uint32_t count, uint32_t start)
+{
+    TEST_EQUAL(m_count, count);
+    for (uint32_t i = 0; (i < count) && (i < m_count); i++)
+    {
+        TEST_EQUAL(m_events[i].event, expected[i].event);
+        TEST_EQUAL(m_events[i].tick - start, expected[i].tick);
+    }
+    m_count = 0;
+}
+
+static void test_short (void)
+{
+    // Levels are sampled 20ms after the first edge of a bounce
+    static const event_t expected[] = { { BUTTON_SHORT, 120 + BUTTON_DOUBLE_MS } };
+    uint32_t start = sim_now();
+
+    bounce(true);
+    until(start, 100);
+    bounce(false);
+    // The edges and the debounce do not start the tone latency
+    until(start, 120 + BUTTON_DOUBLE_MS - 1);
+    TEST_EQUAL(latency_started[LATENCY_BUTTON_TONE], 0);
+    until(start, 1000);
+    check_events(expected, 1, start);
+    TEST_CHECK(latency_started[LATENCY_BUTTON_TONE] != 0);
+    latency_stop(LATENCY_BUTTON_TONE);
+}
+
+static void test_double (void)
+{
+    static const event_t expected[] = { { BUTTON_DOUBLE, 320 } };
+    uint32_t start = sim_now();
+
+    bounce(true);
+    until(start, 100);
+    bounce(false);
+    until(start, 200);
+    bounce(true);
+    until(start, 300);
+    bounce(false);
+    until(start, 1000);
+    check_events(expected, 1, start);
+}
+
+static void test_long (void)
+{
+    static const event_t expected[] = {
+        { BUTTON_LONG, 20 + BUTTON_LONG_MS },
+        { BUTTON_REPEAT, 20 + BUTTON_LONG_MS + BUTTON_REPEAT_MS },
+        { BUTTON_REPEAT, 20 + BUTTON_LONG_MS + 2 * BUTTON_REPEAT_MS },
+    };
+    uint32_t start = sim_now();
+
+    bounce(true);
+    until(start, 1600);
+    bounce(false);
+    until(start, 3000);
+    check_events(expected, 3, start);
+}
+
+// A release edge in the tick of the long press timeout, the debounce and
+// the timeout do not delay each other
+static void test_edge_at_timeout (void)
+{
+    static const event_t expected[] = { { BUTTON_LONG, 20 + BUTTON_LONG_MS } };
+    uint32_t start = sim_now();
+
+    bounce(true);
+    sim_pin_at(start + 20 + BUTTON_LONG_MS, gpioPortF, 4, true);
+    until(start, 20 + BUTTON_LONG_MS + 19);
+    // Not sampled yet
+    TEST_EQUAL(GPIO->IEN & (1 << 4), 0);
+    until(start, 20 + BUTTON_LONG_MS + 20);
+    TEST_CHECK(GPIO->IEN & (1 << 4));
+    // Released, no repeats
+    until(start, 3000);
+    check_events(expected, 1, start);
+}
+
+static void test_glitch (void)
+{
+    uint32_t start = sim_now();
+
+    // Shorter than the debounce time, the level is back when sampled
+    sim_pin_input(gpioPortF, 4, false);
+    sim_advance(5);
+    sim_pin_input(gpioPortF, 4, true);
+    until(start, 1000);
+    check_events(NULL, 0, start);
+}
+
+int main (void)
+{
+    board_init();
+    gpioint_init(NULL);
+    button_init(button_event);
+    sim_start();
+
+    test_short();
+    test_double();
+    test_long();
+    test_edge_at_timeout();
+    test_glitch();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,151 @@
+/**
+ * @brief GPIO interrupt dispatch with synthetic flag masks raised through
+ * the GPIO_EVEN and GPIO_ODD handlers. Checks that every pending interrupt
+ * calls its callback once, in interrupt number order per handler, and that
+ * deferred callbacks follow from the dispatcher thread.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include "test.h"
+#include "sim.h"
+
+#include "em_gpio.h"
+
+#include "gpioint.h"
+
+#define EVEN     0x5555
+#define ODD      0xAAAA
+#define DEFERRED 0xF000 // Interrupts 12 to 15 run in the thread
+#define NONE     (1 << 7) // No callback
+#define ROUNDS   1000
+
+static const osThreadAttr_t m_attr = { .name = "gpioint", .priority = osPriorityAboveNormal };
+
+static uint8_t m_args[GPIOINT_COUNT];
+static uint8_t m_calls[4 * GPIOINT_COUNT];
+static uint32_t m_call_count;
+static uint32_t m_isr_count; // Calls made before the thread ran
+
+static void callback (uint8_t intno, void * arg)
+{
+    TEST_CHECK(arg == &m_args[intno]);
+    if (m_call_count < sizeof(m_calls))
+    {
+        m_calls[m_call_count] = intno;
+    }
+    m_call_count++;
+}
+
+// Raise the flags of a mask, run the handlers and then the thread
+static void fire (uint32_t mask)
+{
+    m_call_count = 0;
+    GPIO->IF |= mask;
+    sim_gpio_irq();
+    m_isr_count = m_call_count;
+    sim_idle();
+    TEST_EQUAL(GPIO->IF, 0);
+}
+
+static uint32_t append (uint8_t * order, uint32_t n, uint32_t flags)
+{
+    for (uint8_t i = 0; i < GPIOINT_COUNT; i++)
+    {
+        if (flags & (1UL << i))
+        {
+            order[n++] = i;
+        }
+    }
+    return n;
+}
+
+// Even interrupts first, then odd, then the deferred ones of both
+static void check (uint32_t mask)
+{
+    uint8_t order[GPIOINT_COUNT];
+    uint32_t n = 0;
+
+    mask &= ~NONE;
+    n = append(order, n, mask & EVEN & ~DEFERRED);
+    n = append(order, n, mask & ODD & ~DEFERRED);
+    TEST_EQUAL(m_isr_count, n);
+    n = append(order, n, mask & DEFERRED);
+    TEST_EQUAL(m_call_count, n);
+    for (uint32_t i = 0; (i < n) && (i < m_call_count); i++)
+    {
+        if (m_calls[i] != order[i])
+        {
+            fprintf(stderr, "mask %04X: call %u is %u, expected %u\n",
+                    (unsigned)mask, (unsigned)i, m_calls[i], order[i]);
+            test_failures++;
+            break;
+        }
+    }
+}
+
+static void test_masks (void)
+{
+    static const uint32_t masks[] = {
+        0x0001, 0x0002, 0x8000, EVEN, ODD, 0xFFFF, 0x0003, 0x0FF0, 0x1248, 0xF001, NONE, NONE | 0x0100,
+    };
+
+    for (uint32_t i = 0; i < sizeof(masks) / sizeof(masks[0]); i++)
+    {
+        fire(masks[i]);
+        check(masks[i]);
+    }
+}
+
+static void test_random (void)
+{
+    uint32_t x = 1;
+    uint32_t calls = 0;
+    uint32_t expected = 0;
+
+    for (uint32_t i = 0; i < ROUNDS; i++)
+    {
+        x = x * 1103515245 + 12345;
+        uint32_t mask = (x >> 8) & 0xFFFF;
+        fire(mask);
+        check(mask);
+        calls += m_call_count;
+        expected += __builtin_popcount(mask & ~NONE);
+    }
+    TEST_EQUAL(calls, expected);
+}
+
+// A deferred interrupt raised again before the thread runs is called once
+static void test_coalesce (void)
+{
+    m_call_count = 0;
+    GPIO->IF |= (1 << 13) | (1 << 2);
+    sim_gpio_irq();
+    GPIO->IF |= (1 << 13) | (1 << 2);
+    sim_gpio_irq();
+    sim_idle();
+    TEST_EQUAL(m_call_count, 3);
+    TEST_EQUAL(m_calls[0], 2);
+    TEST_EQUAL(m_calls[1], 2);
+    TEST_EQUAL(m_calls[2], 13);
+}
+
+int main (void)
+{
+    gpioint_init(&m_attr);
+    sim_start();
+
+    for (uint8_t i = 0; i < GPIOINT_COUNT; i++)
+    {
+        bool deferred = (DEFERRED & (1 << i)) != 0;
+        TEST_CHECK(gpioint_register(i, ((1 << i) & NONE) ? NULL : callback, &m_args[i], deferred));
+    }
+    TEST_CHECK(!gpioint_register(GPIOINT_COUNT, callback, NULL, false));
+    GPIO_IntEnable(0xFFFF);
+
+    test_masks();
+    test_random();
+    test_coalesce();
+
+    return TEST_RESULT();
+}
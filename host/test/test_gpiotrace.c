@@ -0,0 +1,95 @@
+/**
+ * @brief GPIO trace records and the VCD dump through the logger. The tone
+ * is recorded as timer settings and converted to Hz in the dump.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include "test.h"
+#include "sim.h"
+
+#include <string.h>
+
+#include "board.h"
+#include "leds.h"
+#include "tone.h"
+#include "gpiotrace.h"
+#include "log.h"
+
+static char m_log[8192];
+static uint32_t m_log_len;
+
+static int capture (const char *ptr, int len)
+{
+    if (m_log_len + (uint32_t)len < sizeof(m_log))
+    {
+        memcpy(&m_log[m_log_len], ptr, (size_t)len);
+        m_log_len += (uint32_t)len;
+        m_log[m_log_len] = '\0';
+    }
+    return len;
+}
+
+// A logged line with the message, after the module prefix
+static bool logged (const char * msg)
+{
+    char line[64];
+
+    snprintf(line, sizeof(line), "|gtrace:%s\r\n", msg);
+    return strstr(m_log, line) != NULL;
+}
+
+static void test_record (void)
+{
+    tone_note_t note;
+    uint32_t head = gpiotrace_head;
+
+    TEST_CHECK(tone_note(500, &note));
+    TEST_CHECK(tone_play(500, 0));
+    TEST_EQUAL(gpiotrace_head, head + 1);
+
+    // The settings as they are, without a division
+    const gpiotrace_record_t * rec = &gpiotrace_buffer[head & (GPIOTRACE_LEN - 1)];
+    TEST_EQUAL(rec->source, GPIOTRACE_TONE);
+    TEST_EQUAL(rec->value, note.top);
+    TEST_EQUAL(rec->extra, note.presc);
+
+    tone_stop();
+    rec = &gpiotrace_buffer[(head + 1) & (GPIOTRACE_LEN - 1)];
+    TEST_EQUAL(rec->value, 0);
+}
+
+static void test_dump (void)
+{
+    sim_advance(10);
+    leds_set(LEDS_GREEN);
+
+    char header[48];
+    snprintf(header, sizeof(header), "$comment gpiotrace %u records $end", (unsigned)gpiotrace_head);
+
+    m_log_len = 0;
+    gpiotrace_dump();
+
+    TEST_CHECK(logged(header));
+    TEST_CHECK(logged("$var real 32 t buzzer_hz $end"));
+    TEST_CHECK(logged("$enddefinitions $end"));
+    TEST_CHECK(logged("r500 t"));
+    TEST_CHECK(logged("r0 t"));
+    TEST_CHECK(logged("#10000"));
+    TEST_CHECK(logged("1g"));
+    TEST_CHECK(logged("$comment end $end"));
+}
+
+int main (void)
+{
+    log_init(0xFFFF, capture, NULL);
+    board_init();
+    leds_init();
+    tone_init();
+    sim_start();
+
+    test_record();
+    test_dump();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,239 @@
+/**
+ * @brief Tickless idle hook of idle.c, built with configUSE_TICKLESS_IDLE=2
+ * against models of SysTick, the RTCC and the kernel tick count in this
+ * file instead of the simulator. Random run and sleep times, wake-ups by
+ * other interrupts and wake-up latencies check that the tick count does not
+ * drift from the real time and that the deadline tick comes within an RTCC
+ * count of when it is due.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include "test.h"
+
+#include <inttypes.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "em_cmu.h"
+#include "em_emu.h"
+#include "em_rtcc.h"
+
+#include "idle.h"
+
+void vPortSuppressTicksAndSleep (TickType_t expected_ticks);
+
+#define RTCC_HZ     32768ULL
+#define TICK_CYCLES (SIM_HFCLK_HZ / configTICK_RATE_HZ)
+#define RTCC_CYCLES ((SIM_HFCLK_HZ + RTCC_HZ - 1) / RTCC_HZ) // One count, rounded up
+#define READ_CYCLES 12 // An RTCC counter read over the peripheral bus
+#define WAKE_CYCLES 2000 // Up to about 50 us
+#define ROUNDS      10000
+
+SysTick_Type sim_systick;
+
+static uint64_t m_cycles;   // Real time, core clock cycles
+static uint32_t m_phase;    // Cycles into the current tick
+static uint32_t m_ticks;    // Kernel tick count
+static uint32_t m_pending;  // Ticks of SysTick with interrupts disabled
+static uint32_t m_step_max; // vTaskStepTick() must stay below the deadline
+static uint32_t m_first;    // SysTick period after the sleep, 0 for none
+static uint32_t m_compare;
+static uint64_t m_wake_at;  // Another interrupt wakes the core, 0 for none
+static eSleepModeStatus m_status = eStandardSleep;
+static uint32_t m_aborted;  // Sleeps left to the next call by a SysTick wrap
+
+void vTaskStepTick (const TickType_t ticks)
+{
+    m_ticks += ticks;
+    TEST_CHECK(m_ticks <= m_step_max);
+
+    // SysTick has been restarted, still with the rest of the tick loaded
+    TEST_CHECK(SysTick->CTRL & SysTick_CTRL_ENABLE_Msk);
+    TEST_EQUAL(SysTick->VAL, 0);
+    m_first = SysTick->LOAD + 1;
+}
+
+eSleepModeStatus eTaskConfirmSleepModeStatus (void)
+{
+    return m_status;
+}
+
+// Time passes, SysTick counts if it is enabled
+static void advance (uint64_t cycles)
+{
+    m_cycles += cycles;
+    if (SysTick->CTRL & SysTick_CTRL_ENABLE_Msk)
+    {
+        m_phase += (uint32_t)cycles;
+        m_pending += m_phase / TICK_CYCLES;
+        m_phase %= TICK_CYCLES;
+        SysTick->VAL = SysTick->LOAD - m_phase;
+    }
+}
+
+uint32_t RTCC_CounterGet (void)
+{
+    advance(READ_CYCLES);
+    return (uint32_t)(m_cycles * RTCC_HZ / SIM_HFCLK_HZ);
+}
+
+void RTCC_ChannelCCVSet (int ch, uint32_t value)
+{
+    m_compare = value;
+}
+
+static uint32_t m_seed = 1;
+
+static uint32_t random_below (uint32_t n)
+{
+    m_seed = m_seed * 1103515245 + 12345;
+    return (m_seed >> 8) % n;
+}
+
+// Until the counter reaches the compare value or the other interrupt, and
+// the wake-up, which takes its time with the clocks starting
+static void sleep (void)
+{
+    uint64_t wake = ((uint64_t)m_compare * SIM_HFCLK_HZ + RTCC_HZ - 1) / RTCC_HZ;
+
+    if ((m_wake_at != 0) && (m_wake_at < wake))
+    {
+        wake = m_wake_at;
+    }
+    if (wake > m_cycles)
+    {
+        advance(wake - m_cycles);
+    }
+    advance(random_below(WAKE_CYCLES));
+}
+
+void EMU_EnterEM1 (void)
+{
+    sleep();
+}
+
+void EMU_EnterEM2 (bool restore)
+{
+    sleep();
+}
+
+void RTCC_Init (const RTCC_Init_TypeDef *init) {}
+void RTCC_Enable (bool enable) {}
+void RTCC_ChannelInit (int ch, const RTCC_CCChConf_TypeDef *conf) {}
+void RTCC_IntClear (uint32_t flags) {}
+void RTCC_IntEnable (uint32_t flags) {}
+uint32_t RTCC_IntGetEnabled (void) { return 0; }
+void CMU_ClockEnable (CMU_Clock_TypeDef clock, bool enable) {}
+void CMU_ClockSelectSet (CMU_Clock_TypeDef clock, CMU_Select_TypeDef ref) {}
+void NVIC_EnableIRQ (IRQn_Type irq) {}
+void NVIC_ClearPendingIRQ (IRQn_Type irq) {}
+
+// Run with SysTick counting the ticks
+static void run (uint32_t cycles)
+{
+    advance(cycles);
+    m_ticks += m_pending;
+    m_pending = 0;
+}
+
+// The idle hook with SysTick at its current phase, the tick that is due
+// after expected ticks comes from SysTick, returns when in cycles
+static uint64_t idle (uint32_t expected)
+{
+    uint32_t due = m_ticks + expected;
+
+    SysTick->LOAD = TICK_CYCLES - 1;
+    SysTick->VAL = SysTick->LOAD - m_phase;
+    SysTick->CTRL = SysTick_CTRL_ENABLE_Msk;
+    m_step_max = due - 1;
+
+    m_pending = 0;
+    m_first = 0;
+
+    vPortSuppressTicksAndSleep(expected);
+
+    TEST_CHECK(SysTick->CTRL & SysTick_CTRL_ENABLE_Msk);
+    TEST_EQUAL(SysTick->LOAD, TICK_CYCLES - 1);
+    if (m_pending != 0)
+    {
+        // SysTick wrapped before the sleep, the tick interrupt runs now
+        TEST_EQUAL(m_ticks, due - expected);
+        m_ticks += m_pending;
+        m_pending = 0;
+        m_aborted++;
+    }
+    else if (m_status != eAbortSleep)
+    {
+        // The first period is the rest of the tick
+        TEST_CHECK((m_first > 1) && (m_first <= TICK_CYCLES));
+        m_phase = TICK_CYCLES - m_first;
+    }
+    return m_cycles - m_phase + (uint64_t)(due - m_ticks) * TICK_CYCLES;
+}
+
+static void test_abort (void)
+{
+    uint32_t ticks = m_ticks;
+    uint64_t cycles = m_cycles;
+    uint32_t phase = m_phase;
+
+    m_status = eAbortSleep;
+    idle(10);
+    m_status = eStandardSleep;
+    TEST_EQUAL(m_ticks, ticks);
+    TEST_EQUAL(m_cycles, cycles);
+    TEST_EQUAL(m_phase, phase);
+}
+
+static void test_accuracy (void)
+{
+    int64_t late_max = 0;
+    int64_t early_max = 0;
+    int64_t drift_max = 0;
+
+    for (uint32_t i = 0; i < ROUNDS; i++)
+    {
+        run(random_below(3 * TICK_CYCLES));
+
+        uint32_t expected = 2 + random_below(200);
+        uint32_t due = m_ticks + expected;
+        // Every fourth sleep ends early with another interrupt
+        m_wake_at = (random_below(4) == 0) ? m_cycles + random_below(expected * TICK_CYCLES) : 0;
+        uint32_t aborted = m_aborted;
+        uint64_t due_at = idle(expected);
+
+        // The tick count follows the real time
+        int64_t real = (int64_t)(m_cycles / TICK_CYCLES);
+        int64_t drift = real - (int64_t)m_ticks;
+        drift_max = (drift > drift_max) ? drift : drift_max;
+        drift_max = (-drift > drift_max) ? -drift : drift_max;
+
+        // The deadline against the real time of that tick
+        if ((m_wake_at == 0) && (m_aborted == aborted))
+        {
+            int64_t error = (int64_t)due_at - (int64_t)due * TICK_CYCLES;
+            late_max = (error > late_max) ? error : late_max;
+            early_max = (-error > early_max) ? -error : early_max;
+        }
+    }
+    m_wake_at = 0;
+
+    printf("idle %u rounds, %"PRIu32" left to SysTick: drift %"PRId64" ticks, deadline %"PRId64" early %"PRId64" late cycles\n",
+           ROUNDS, m_aborted, drift_max, early_max, late_max);
+    TEST_CHECK(drift_max <= 1);
+    // Within a count of the tick, what is left is the reads finding the edges
+    TEST_CHECK(early_max <= RTCC_CYCLES);
+    TEST_CHECK(late_max <= RTCC_CYCLES);
+}
+
+int main (void)
+{
+    idle_init();
+
+    test_abort();
+    test_accuracy();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,95 @@
+/**
+ * @brief Software image CRC against a bitwise reference, with and without
+ * a hole, and the image CRC against the one in the embedded header.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include "test.h"
+#include "sim.h"
+
+#include "em_device.h"
+
+#include "imagecrc.h"
+#include "appheader.h"
+
+static uint16_t reference_from (uint16_t crc, const uint8_t * p, uint32_t len)
+{
+    while (len--)
+    {
+        crc ^= (uint16_t)(*p++) << 8;
+        for (uint8_t b = 0; b < 8; b++)
+        {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+static uint16_t reference (const uint8_t * p, uint32_t len)
+{
+    return reference_from(IMAGECRC_INIT, p, len);
+}
+
+static void test_skip (void)
+{
+    const uint8_t * p = &sim_image[3];
+    uint16_t crc;
+
+    // Hole in the middle, at either end and the whole area
+    crc = reference_from(reference(p, 100), p + 150, 850);
+    TEST_EQUAL(imagecrc_compute_skip(p, 1000, p + 100, 50), crc);
+    TEST_EQUAL(imagecrc_compute_skip(p, 1000, p, 50), reference(p + 50, 950));
+    TEST_EQUAL(imagecrc_compute_skip(p, 1000, p + 950, 50), reference(p, 950));
+    TEST_EQUAL(imagecrc_compute_skip(p, 1000, p, 1000), IMAGECRC_INIT);
+
+    // Cut at the end, no hole when outside of the area or empty
+    TEST_EQUAL(imagecrc_compute_skip(p, 1000, p + 990, 50), reference(p, 990));
+    TEST_EQUAL(imagecrc_compute_skip(p, 1000, p + 1000, 50), reference(p, 1000));
+    TEST_EQUAL(imagecrc_compute_skip(p, 1000, p - 1, 50), reference(p, 1000));
+    TEST_EQUAL(imagecrc_compute_skip(p, 1000, NULL, 50), reference(p, 1000));
+    TEST_EQUAL(imagecrc_compute_skip(p, 1000, p + 100, 0), reference(p, 1000));
+}
+
+static void test_header (void)
+{
+    const appheader_t * h = appheader_get();
+
+    TEST_CHECK(h != NULL);
+    if (h != NULL)
+    {
+        uint16_t crc = imagecrc_compute_skip(imagecrc_image_start(), imagecrc_image_size(),
+                                             h, h->header_size);
+        TEST_EQUAL(crc, h->crc);
+        TEST_CHECK(imagecrc_compute(imagecrc_image_start(), imagecrc_image_size()) != h->crc);
+    }
+}
+
+int main (void)
+{
+    static const uint32_t lengths[] = { 0, 1, 7, 8, 9, 15, 16, 17, 255, 1000 };
+    static const uint32_t offsets[] = { 0, 1, 3, 5 };
+
+    // No GPCRC on the host
+    TEST_CHECK(!imagecrc_init());
+    TEST_EQUAL(imagecrc_compute("123456789", 9), 0x29B1);
+
+    for (uint32_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++)
+    {
+        for (uint32_t o = 0; o < sizeof(offsets) / sizeof(offsets[0]); o++)
+        {
+            const uint8_t * p = &sim_image[offsets[o]];
+            TEST_EQUAL(imagecrc_compute(p, lengths[l]), reference(p, lengths[l]));
+        }
+    }
+
+    TEST_CHECK(imagecrc_image_start() == (const void *)sim_image);
+    TEST_EQUAL(imagecrc_image_size(), 4096 + 256);
+    TEST_EQUAL(imagecrc_compute(imagecrc_image_start(), imagecrc_image_size()),
+               reference(sim_image, imagecrc_image_size()));
+
+    test_skip();
+    test_header();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,102 @@
+/**
+ * @brief Kernel lock of the simulator against the CMSIS-FreeRTOS semantics:
+ * osKernelRestoreLock(1) adds a suspend level, the scheduler runs again
+ * when all levels are resumed, switches wait for it and blocking while it
+ * is suspended is a fault.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include "test.h"
+#include "sim.h"
+
+#include "cmsis_os2.h"
+
+static osThreadId_t m_high;
+static uint32_t m_high_runs;
+
+static void high_thread (void * argument)
+{
+    (void)argument;
+    while (true)
+    {
+        osThreadFlagsWait(1, osFlagsWaitAny, osWaitForever);
+        m_high_runs++;
+    }
+}
+
+static void test_nesting (void)
+{
+    TEST_EQUAL(osKernelLock(), 0);
+    TEST_EQUAL(osKernelGetState(), osKernelLocked);
+    // Already locked, no new level
+    TEST_EQUAL(osKernelLock(), 1);
+    // A nested section restoring 1 suspends once more
+    TEST_EQUAL(osKernelRestoreLock(1), 1);
+    TEST_EQUAL(osKernelUnlock(), osError);
+    TEST_EQUAL(osKernelGetState(), osKernelLocked);
+    TEST_EQUAL(osKernelUnlock(), 1);
+    TEST_EQUAL(osKernelGetState(), osKernelRunning);
+    TEST_EQUAL(osKernelUnlock(), 0);
+
+    // Nested pairs leave a level behind: the inner restore suspends once
+    // more and the outer one cannot resume the scheduler
+    int32_t outer = osKernelLock();
+    int32_t inner = osKernelLock();
+    TEST_EQUAL(osKernelRestoreLock(inner), 1);
+    TEST_EQUAL(osKernelRestoreLock(outer), osError);
+    TEST_EQUAL(osKernelGetState(), osKernelLocked);
+    TEST_EQUAL(osKernelUnlock(), 1);
+    TEST_EQUAL(osKernelGetState(), osKernelRunning);
+    TEST_EQUAL(sim_faults(), 0);
+
+    // Resuming a running scheduler asserts on the target
+    osKernelRestoreLock(0);
+    TEST_EQUAL(sim_faults(), 1);
+}
+
+static uint32_t m_runs_locked;
+static uint32_t m_runs_unlocked;
+
+static void low_thread (void * argument)
+{
+    (void)argument;
+    osKernelLock();
+    osThreadFlagsSet(m_high, 1);
+    m_runs_locked = m_high_runs;
+    osKernelUnlock();
+    m_runs_unlocked = m_high_runs;
+
+    // Blocks with the scheduler suspended
+    osKernelLock();
+    osDelay(1);
+    osKernelUnlock();
+}
+
+static void test_deferred (void)
+{
+    uint32_t faults = sim_faults();
+
+    m_high = osThreadNew(high_thread, NULL, &(osThreadAttr_t){ .name = "high", .priority = osPriorityHigh });
+    osThreadNew(low_thread, NULL, &(osThreadAttr_t){ .name = "low", .priority = osPriorityLow });
+    sim_idle();
+
+    // The switch to the woken thread waits for the unlock
+    TEST_EQUAL(m_runs_locked, 0);
+    TEST_EQUAL(m_runs_unlocked, 1);
+
+    sim_advance(2);
+    TEST_EQUAL(sim_faults(), faults + 1);
+    TEST_EQUAL(osKernelGetState(), osKernelRunning);
+}
+
+int main (void)
+{
+    osKernelInitialize();
+    sim_start();
+
+    test_nesting();
+    test_deferred();
+
+    return TEST_RESULT();
+}
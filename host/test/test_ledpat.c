@@ -0,0 +1,149 @@
+/**
+ * @brief LED pattern timing on the simulated pins.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include "test.h"
+#include "sim.h"
+
+#include "board.h"
+#include "leds.h"
+#include "ledpat.h"
+
+#define GREEN gpioPortB, 12
+#define RED   gpioPortB, 11
+#define BLUE  gpioPortA, 5
+
+// Changes of one pin recorded since the trace was cleared
+static uint32_t changes (uint8_t port, uint8_t pin, const sim_trace_t * out[], uint32_t max)
+{
+    uint32_t n = 0;
+
+    for (uint32_t i = 0; i < sim_trace_count(); i++)
+    {
+        const sim_trace_t * t = sim_trace_get(i);
+        if ((t->port == port) && (t->pin == pin))
+        {
+            if (n < max)
+            {
+                out[n] = t;
+            }
+            n++;
+        }
+    }
+    return n;
+}
+
+static void test_blink (void)
+{
+    static const ledpat_t blink = LEDPAT_BLINK(500, 500);
+    const sim_trace_t * t[8];
+    uint32_t start = sim_now();
+
+    sim_trace_clear();
+    ledpat_start(LEDS_GREEN, &blink);
+    TEST_EQUAL(sim_pin(GREEN)->level, 1);
+    sim_advance(499);
+    TEST_EQUAL(sim_pin(GREEN)->level, 1);
+    sim_advance(1);
+    TEST_EQUAL(sim_pin(GREEN)->level, 0);
+    sim_advance(1500);
+
+    TEST_EQUAL(changes(GREEN, t, 8), 5);
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        TEST_EQUAL(t[i]->tick - start, i * 500);
+        TEST_EQUAL(t[i]->level, (i % 2) == 0);
+        TEST_EQUAL(t[i]->hz, 0);
+    }
+
+    sim_trace_clear();
+    ledpat_stop(LEDS_GREEN);
+    sim_advance(2000);
+    TEST_EQUAL(changes(GREEN, t, 8), 1);
+    TEST_EQUAL(sim_pin(GREEN)->level, 0);
+}
+
+static void test_heartbeat (void)
+{
+    static const ledpat_t heartbeat = LEDPAT_HEARTBEAT;
+    // The pause follows the off time of the last flash
+    static const uint32_t expected[] = { 0, 100, 250, 350, 1150, 1250, 1400, 1500 };
+    const sim_trace_t * t[16];
+    uint32_t start = sim_now();
+
+    sim_trace_clear();
+    ledpat_start(LEDS_RED, &heartbeat);
+    sim_advance(1999);
+    TEST_EQUAL(changes(RED, t, 16), 8);
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        TEST_EQUAL(t[i]->tick - start, expected[i]);
+    }
+    ledpat_stop(LEDS_RED);
+}
+
+static void test_pulse (void)
+{
+    static const ledpat_t pulse = LEDPAT_PULSE(100);
+    const sim_trace_t * t[4];
+    uint32_t start = sim_now();
+
+    sim_trace_clear();
+    ledpat_start(LEDS_RED, &pulse);
+    sim_advance(1000);
+    TEST_EQUAL(changes(RED, t, 4), 2);
+    TEST_EQUAL(t[0]->tick - start, 0);
+    TEST_EQUAL(t[1]->tick - start, 100);
+    TEST_EQUAL(sim_pin(RED)->level, 0);
+}
+
+static void test_breathe (void)
+{
+    static const ledpat_t breathe = LEDPAT_BREATHE(640);
+    const sim_trace_t * t[256];
+    uint16_t peak = 0;
+    uint32_t peak_tick = 0;
+    uint32_t start = sim_now();
+
+    sim_trace_clear();
+    ledpat_start(LEDS_BLUE, &breathe);
+    sim_advance(640);
+    ledpat_stop(LEDS_BLUE);
+
+    uint32_t n = changes(BLUE, t, 256);
+    TEST_CHECK((n > 20) && (n <= 256));
+    for (uint32_t i = 0; (i < n) && (i < 256); i++)
+    {
+        if (t[i]->hz != 0)
+        {
+            TEST_EQUAL(t[i]->hz, 585); // 38.4MHz / 256 / 256
+            if (t[i]->duty > peak)
+            {
+                peak = t[i]->duty;
+                peak_tick = t[i]->tick - start;
+            }
+        }
+    }
+    // Full brightness in the middle is a plain high level
+    TEST_CHECK(peak >= 240);
+    TEST_CHECK((peak_tick > 200) && (peak_tick < 440));
+    TEST_EQUAL(sim_pin(BLUE)->level, 0);
+    TEST_EQUAL(sim_pin(BLUE)->hz, 0);
+}
+
+int main (void)
+{
+    board_init();
+    leds_init();
+    ledpat_init();
+    sim_start();
+
+    test_blink();
+    test_heartbeat();
+    test_pulse();
+    test_breathe();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,200 @@
+/**
+ * @brief Software PWM of leds.c, built with LEDS_SOFT_PWM=1. TIMER1 is
+ * stepped here count by count: the overflow and compare flags are raised
+ * like the hardware does and the interrupt handler runs when they are
+ * enabled, after a latency. The pins sampled at every count give the duty
+ * cycle, the GPIO trace records the port writes of each interrupt.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include "test.h"
+#include "sim.h"
+
+#include <time.h>
+
+#include "em_timer.h"
+
+#include "board.h"
+#include "leds.h"
+#include "gpiotrace.h"
+
+#define RED   gpioPortB, 11
+#define GREEN gpioPortB, 12
+#define BLUE  gpioPortA, 5
+
+#define SOFT_CC  3 // LEDS_SOFT_CC
+#define PERIOD   (LEDS_LEVEL_MAX + 1)
+#define PERIODS  8
+#define BENCH_MS 100
+
+void TIMER1_IRQHandler (void);
+
+static uint32_t m_latency;  // Counts from a flag to the interrupt
+static uint32_t m_waiting;  // Counts the raised flags have waited
+static uint32_t m_irqs;
+static uint32_t m_writes;   // Port writes by the interrupt
+static uint32_t m_writes_max;
+static uint32_t m_high[LEDS_COUNT];
+
+static void irq (void)
+{
+    uint32_t head = gpiotrace_head;
+
+    TIMER1_IRQHandler();
+    m_irqs++;
+    m_writes += gpiotrace_head - head;
+    if (gpiotrace_head - head > m_writes_max)
+    {
+        m_writes_max = gpiotrace_head - head;
+    }
+}
+
+static bool pin_high (GPIO_Port_TypeDef port, unsigned int pin)
+{
+    return (GPIO_PortOutGet(port) >> pin) & 1;
+}
+
+// One timer count: the flags it raises, the interrupt if it is due and the
+// pins, sampled before the next count
+static void count (void)
+{
+    TIMER_TypeDef * timer = TIMER1;
+
+    timer->CNT = (timer->CNT >= timer->TOP) ? 0 : timer->CNT + 1;
+    if (timer->CNT == 0)
+    {
+        timer->IF |= TIMER_IF_OF;
+    }
+    if (timer->CNT == timer->CC[SOFT_CC].CCV)
+    {
+        timer->IF |= (TIMER_IF_CC0 << SOFT_CC);
+    }
+
+    if ((timer->IF & timer->IEN) != 0)
+    {
+        if (m_waiting >= m_latency)
+        {
+            irq();
+            m_waiting = 0;
+        }
+        else
+        {
+            m_waiting++;
+        }
+    }
+
+    m_high[0] += pin_high(RED);
+    m_high[1] += pin_high(GREEN);
+    m_high[2] += pin_high(BLUE);
+}
+
+// Whole periods from the overflow, with the counts of each LED high
+static void run (uint32_t periods)
+{
+    TIMER1->CNT = TIMER1->TOP;
+    for (uint32_t i = 0; i < LEDS_COUNT; i++)
+    {
+        m_high[i] = 0;
+    }
+    m_irqs = 0;
+    m_writes = 0;
+    m_writes_max = 0;
+    for (uint32_t i = 0; i < periods * PERIOD; i++)
+    {
+        count();
+    }
+}
+
+static void levels (uint8_t red, uint8_t green, uint8_t blue)
+{
+    leds_brightness_set(LEDS_RED, red);
+    leds_brightness_set(LEDS_GREEN, green);
+    leds_brightness_set(LEDS_BLUE, blue);
+    leds_set(LEDS_ALL);
+    // The first period starts from the pins apply() left
+    m_latency = 0;
+    run(1);
+}
+
+static void test_duty (void)
+{
+    levels(64, 128, 200);
+    run(PERIODS);
+
+    // On from the overflow until the counter reaches the level
+    TEST_EQUAL(m_high[0], PERIODS * 64);
+    TEST_EQUAL(m_high[1], PERIODS * 128);
+    TEST_EQUAL(m_high[2], PERIODS * 200);
+    // The overflow and one compare per level, one write per port each
+    TEST_EQUAL(m_irqs, PERIODS * 4);
+    TEST_EQUAL(m_writes, PERIODS * (2 + 3));
+    TEST_EQUAL(m_writes_max, 2);
+
+    // Equal levels share the compare and the write of their port
+    levels(100, 100, 1);
+    run(PERIODS);
+    TEST_EQUAL(m_high[0], PERIODS * 100);
+    TEST_EQUAL(m_high[1], PERIODS * 100);
+    TEST_EQUAL(m_high[2], PERIODS * 1);
+    TEST_EQUAL(m_irqs, PERIODS * 3);
+    TEST_EQUAL(m_writes, PERIODS * (2 + 2));
+}
+
+// A compare that is pending together with the overflow, or that the
+// counter passed while the interrupt waited, still turns its LEDs off. The
+// edges come the latency late, levels below it leave their LEDs off.
+static void test_late (void)
+{
+    levels(1, 2, 40);
+    m_latency = 3;
+    run(PERIODS);
+
+    // The overflow and the compares of 1 and 2 handled at count 3
+    TEST_EQUAL(m_high[0], 0);
+    TEST_EQUAL(m_high[1], 0);
+    TEST_EQUAL(m_high[2], PERIODS * 40);
+    TEST_EQUAL(m_irqs, PERIODS * 2);
+    TEST_EQUAL(m_writes, PERIODS * 2);
+    m_latency = 0;
+}
+
+// Host time of the interrupt for three distinct levels
+static void bench_irq (void)
+{
+    struct timespec start;
+    struct timespec end;
+    uint32_t periods = 0;
+    double ms;
+
+    levels(64, 128, 200);
+    uint32_t irqs = m_irqs;
+    uint32_t writes = m_writes;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    do
+    {
+        for (uint32_t i = 0; i < PERIOD; i++)
+        {
+            count();
+        }
+        periods++;
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        ms = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1000000.0;
+    } while (ms < BENCH_MS);
+
+    printf("leds soft PWM: %u interrupts and %u port writes per period, %.0f ns per period on the host\n",
+           (unsigned)((m_irqs - irqs) / periods), (unsigned)((m_writes - writes) / periods), ms * 1000000.0 / periods);
+}
+
+int main (void)
+{
+    board_init();
+    leds_init();
+    sim_start();
+
+    test_duty();
+    test_late();
+    bench_irq();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,83 @@
+/**
+ * @brief Ring logger order, truncation and drop reporting, the drain
+ * thread output is captured from stdout.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include "test.h"
+#include "sim.h"
+
+#include <string.h>
+#include <unistd.h>
+
+#include "cmsis_os2.h"
+
+#include "logger_ring.h"
+
+static FILE * m_capture;
+static char m_output[4096];
+
+static void capture_start (void)
+{
+    m_capture = tmpfile();
+    fflush(stdout);
+    dup2(fileno(m_capture), STDOUT_FILENO);
+}
+
+static const char * captured (void)
+{
+    fflush(stdout);
+    fseek(m_capture, 0, SEEK_SET);
+    size_t len = fread(m_output, 1, sizeof(m_output) - 1, m_capture);
+    m_output[len] = '\0';
+    return m_output;
+}
+
+static void log_line (uint32_t n)
+{
+    char line[16];
+    int len = snprintf(line, sizeof(line), "msg %02u\r\n", (unsigned)n);
+    logger_ring(line, len);
+}
+
+int main (void)
+{
+    char expected[4096] = "";
+    char line[LOGGER_RING_SLOT_SIZE + 64];
+
+    capture_start();
+    logger_ring_init(NULL);
+
+    // The drain thread does not run before the kernel starts, the ring fills
+    for (uint32_t i = 0; i < LOGGER_RING_SLOTS + 4; i++)
+    {
+        log_line(i);
+    }
+    TEST_EQUAL(logger_ring_dropped(), 4);
+    TEST_EQUAL(logger_ring_pending(), LOGGER_RING_SLOTS);
+    TEST_EQUAL(strlen(captured()), 0);
+
+    sim_start();
+    for (uint32_t i = 0; i < LOGGER_RING_SLOTS; i++)
+    {
+        snprintf(&expected[strlen(expected)], 16, "msg %02u\r\n", (unsigned)i);
+    }
+    strcat(expected, "log dropped 4\r\n");
+    TEST_CHECK(strcmp(captured(), expected) == 0);
+    TEST_EQUAL(logger_ring_pending(), 0);
+
+    // Longer messages are cut at the slot size
+    memset(line, 'x', sizeof(line));
+    logger_ring(line, sizeof(line));
+    log_line(99);
+    sim_idle();
+    size_t len = strlen(expected);
+    memset(&expected[len], 'x', LOGGER_RING_SLOT_SIZE);
+    expected[len + LOGGER_RING_SLOT_SIZE] = '\0';
+    strcat(expected, "msg 99\r\n");
+    TEST_CHECK(strcmp(captured(), expected) == 0);
+    TEST_EQUAL(logger_ring_dropped(), 4);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,128 @@
+/**
+ * @brief Tone and melody timing on the simulated buzzer pin.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include "test.h"
+#include "sim.h"
+
+#include "board.h"
+#include "tone.h"
+#include "melody.h"
+
+#define BUZZER gpioPortA, 0
+
+// Last change of the buzzer pin at or before a tick
+static const sim_trace_t * at (uint32_t tick)
+{
+    const sim_trace_t * last = NULL;
+
+    for (uint32_t i = 0; i < sim_trace_count(); i++)
+    {
+        const sim_trace_t * t = sim_trace_get(i);
+        if ((t->port == gpioPortA) && (t->pin == 0) && ((int32_t)(t->tick - tick) <= 0))
+        {
+            last = t;
+        }
+    }
+    return last;
+}
+
+static void test_note (void)
+{
+    tone_note_t note;
+
+    TEST_CHECK(!tone_note(0, &note));
+    TEST_CHECK(!tone_note(TONE_TIMER_HZ, &note));
+
+    TEST_CHECK(tone_note(NOTE_A4, &note));
+    TEST_EQUAL(note.presc, 1);
+    TEST_EQUAL(note.top, (TONE_TIMER_HZ >> 1) / NOTE_A4 - 1);
+
+    // The compile-time conversion gives the same values
+    static const tone_note_t a4 = TONE_NOTE(NOTE_A4);
+    TEST_EQUAL(a4.presc, note.presc);
+    TEST_EQUAL(a4.top, note.top);
+}
+
+static void test_tone (void)
+{
+    uint32_t start = sim_now();
+
+    sim_trace_clear();
+    TEST_CHECK(tone_play(1000, 30));
+    TEST_CHECK(tone_active());
+    sim_advance(100);
+
+    TEST_EQUAL(at(start)->hz, 1000);
+    TEST_EQUAL(at(start)->duty, 128);
+    TEST_EQUAL(at(start + 29)->hz, 1000);
+    TEST_EQUAL(at(start + 30)->tick, start + 30);
+    TEST_EQUAL(at(start + 30)->level, 0);
+    TEST_EQUAL(at(start + 30)->hz, 0);
+    TEST_CHECK(!tone_active());
+}
+
+static void test_siren (void)
+{
+    static const melody_step_t steps[] = {
+        MELODY_STEP(500, 200, 50),
+        MELODY_STEP(250, 200, 50),
+    };
+    static const melody_t siren = { steps, 2, false };
+    uint32_t start = sim_now();
+
+    sim_trace_clear();
+    TEST_CHECK(melody_play(&siren));
+    TEST_CHECK(melody_active());
+    sim_advance(1000);
+
+    TEST_EQUAL(at(start)->hz, 500);
+    TEST_EQUAL(at(start)->duty, 128);
+    TEST_EQUAL(at(start + 199)->hz, 500);
+    TEST_EQUAL(at(start + 200)->hz, 0);
+    TEST_EQUAL(at(start + 249)->level, 0);
+    TEST_EQUAL(at(start + 250)->hz, 250);
+    TEST_EQUAL(at(start + 449)->hz, 250);
+    TEST_EQUAL(at(start + 450)->hz, 0);
+    TEST_EQUAL(at(start + 1000)->tick, start + 450);
+    TEST_CHECK(!melody_active());
+}
+
+static void test_loop (void)
+{
+    static const melody_step_t steps[] = {
+        MELODY_STEP(NOTE_C5, 100, 0),
+        MELODY_PAUSE(100),
+    };
+    static const melody_t loop = { steps, 2, true };
+    uint32_t start = sim_now();
+
+    sim_trace_clear();
+    TEST_CHECK(melody_play(&loop));
+    sim_advance(1000);
+    TEST_CHECK(melody_active());
+    TEST_EQUAL(at(start + 800)->hz, (TONE_TIMER_HZ >> 1) / ((TONE_TIMER_HZ >> 1) / NOTE_C5));
+    TEST_EQUAL(at(start + 900)->level, 0);
+
+    melody_stop();
+    TEST_CHECK(!melody_active());
+    TEST_EQUAL(sim_pin(BUZZER)->level, 0);
+    TEST_EQUAL(sim_pin(BUZZER)->hz, 0);
+}
+
+int main (void)
+{
+    board_init();
+    tone_init();
+    melody_init();
+    sim_start();
+
+    test_note();
+    test_tone();
+    test_siren();
+    test_loop();
+
+    return TEST_RESULT();
+}
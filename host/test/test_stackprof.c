@@ -0,0 +1,117 @@
+/**
+ * @brief Stack profiler on the simulator, the threads report synthetic
+ * free stack space with sim_stack_space(). Checks the alarm threshold, that
+ * a thread alarms once, the kept minimum and the dump.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include "test.h"
+#include "sim.h"
+
+#include <string.h>
+
+#include "stackprof.h"
+#include "log.h"
+
+static const osThreadAttr_t m_a_attr = { .name = "a", .stack_size = 1024 };
+static const osThreadAttr_t m_b_attr = { .name = "b", .stack_size = 512 };
+static const osThreadAttr_t * const m_attrs[] = { &m_a_attr, &m_b_attr };
+
+static osThreadId_t m_a;
+static osThreadId_t m_b;
+
+static osThreadId_t m_alarm_thread;
+static uint32_t m_alarm_free;
+static uint32_t m_alarms;
+
+static char m_log[4096];
+static uint32_t m_log_len;
+
+static int capture (const char *ptr, int len)
+{
+    if (m_log_len + (uint32_t)len < sizeof(m_log))
+    {
+        memcpy(&m_log[m_log_len], ptr, (size_t)len);
+        m_log_len += (uint32_t)len;
+        m_log[m_log_len] = '\0';
+    }
+    return len;
+}
+
+// A logged line with the message, after the module prefix
+static bool logged (const char * msg)
+{
+    char line[64];
+
+    snprintf(line, sizeof(line), "|stack:%s\r\n", msg);
+    return strstr(m_log, line) != NULL;
+}
+
+static void alarm (osThreadId_t thread, uint32_t free)
+{
+    m_alarm_thread = thread;
+    m_alarm_free = free;
+    m_alarms++;
+}
+
+static void idle_thread (void * argument)
+{
+    for (;;)
+    {
+        osDelay(osWaitForever);
+    }
+}
+
+// Let the sampling timer run once
+static void period (void)
+{
+    sim_advance(STACKPROF_PERIOD_MS);
+}
+
+static void test_threshold (void)
+{
+    sim_stack_space(m_a, 600);
+    sim_stack_space(m_b, 200);
+    period();
+    TEST_EQUAL(m_alarms, 0);
+
+    // Only less than the threshold alarms
+    sim_stack_space(m_b, STACKPROF_ALARM_BYTES);
+    period();
+    TEST_EQUAL(m_alarms, 0);
+
+    m_log_len = 0;
+    sim_stack_space(m_b, STACKPROF_ALARM_BYTES - 1);
+    period();
+    TEST_EQUAL(m_alarms, 1);
+    TEST_CHECK(m_alarm_thread == m_b);
+    TEST_EQUAL(m_alarm_free, STACKPROF_ALARM_BYTES - 1);
+    TEST_CHECK(logged("b free 127"));
+
+    // Once per thread, also when it gets worse
+    sim_stack_space(m_b, 40);
+    period();
+    TEST_EQUAL(m_alarms, 1);
+
+    // The minimum is kept when the stack is freed again
+    m_log_len = 0;
+    sim_stack_space(m_b, 400);
+    stackprof_dump();
+    TEST_CHECK(logged("b              512    40   92 !"));
+    TEST_CHECK(logged("a             1024   600   41"));
+}
+
+int main (void)
+{
+    log_init(0xFFFF, capture, NULL);
+
+    m_a = osThreadNew(idle_thread, NULL, &m_a_attr);
+    m_b = osThreadNew(idle_thread, NULL, &m_b_attr);
+    stackprof_init(alarm, m_attrs, sizeof(m_attrs) / sizeof(m_attrs[0]));
+    sim_start();
+
+    test_threshold();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,234 @@
+/**
+ * @brief Tickless idle implementation for FreeRTOS, configUSE_TICKLESS_IDLE=2.
+ *
+ * vPortSuppressTicksAndSleep() stops SysTick, sets RTCC compare channel 1
+ * to the expected wake-up time and sleeps in EM2, or in EM1 when EM2 is
+ * blocked or the idle time is short. After wake-up the kernel tick count is
+ * stepped by the time measured with the RTCC and the part of a tick that
+ * SysTick had counted before it was stopped. Ticks are 1/configTICK_RATE_HZ
+ * and RTCC counts 1/32768 seconds, the fraction of a tick left over is
+ * carried over as a shorter first SysTick period, so the tick count does
+ * not drift and the ticks stay where they were. SysTick is stopped and
+ * restarted at RTCC count edges, which costs up to two counts awake with
+ * interrupts disabled per sleep but leaves no part of a count unmeasured.
+ *
+ * The same RTCC counts are used to account the time spent in each energy
+ * mode, so the statistics cost nothing while running.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include "idle.h"
+
+#include <stdbool.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "em_cmu.h"
+#include "em_emu.h"
+#include "em_rtcc.h"
+
+#include "retargetserial.h"
+
+#define IDLE_RTCC_HZ 32768UL
+#define IDLE_RTCC_CC 1
+
+// Keep count * configTICK_RATE_HZ within 32 bits
+#define IDLE_MAX_COUNTS (UINT32_MAX / configTICK_RATE_HZ)
+#define IDLE_MAX_TICKS  ((IDLE_MAX_COUNTS / IDLE_RTCC_HZ) * configTICK_RATE_HZ)
+
+static volatile uint32_t m_em2_block;
+
+void idle_em2_block (void)
+{
+    __atomic_fetch_add(&m_em2_block, 1, __ATOMIC_RELAXED);
+}
+
+void idle_em2_unblock (void)
+{
+    __atomic_fetch_sub(&m_em2_block, 1, __ATOMIC_RELAXED);
+}
+
+#if configUSE_TICKLESS_IDLE == 2
+
+static uint32_t m_em1_counts;
+static uint32_t m_em2_counts;
+static uint32_t m_stats_start;
+
+void idle_init (void)
+{
+    CMU_ClockSelectSet(cmuClock_LFE, cmuSelect_LFXO);
+    CMU_ClockEnable(cmuClock_RTCC, true);
+
+    RTCC_Init_TypeDef init = RTCC_INIT_DEFAULT;
+    init.enable = false;
+    init.debugRun = true;
+    init.presc = rtccCntPresc_1;
+    RTCC_Init(&init);
+
+    RTCC_CCChConf_TypeDef compare = RTCC_CH_INIT_COMPARE_DEFAULT;
+    RTCC_ChannelInit(IDLE_RTCC_CC, &compare);
+
+    RTCC_IntClear(RTCC_IF_CC1);
+    RTCC_IntEnable(RTCC_IEN_CC1);
+    NVIC_ClearPendingIRQ(RTCC_IRQn);
+    NVIC_EnableIRQ(RTCC_IRQn);
+
+    RTCC_Enable(true);
+    m_stats_start = RTCC_CounterGet();
+}
+
+void RTCC_IRQHandler (void)
+{
+    RTCC_IntClear(RTCC_IntGetEnabled());
+}
+
+void idle_stats (idle_stats_t * stats)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint32_t now = RTCC_CounterGet();
+    uint32_t total = now - m_stats_start;
+    uint32_t em1 = m_em1_counts;
+    uint32_t em2 = m_em2_counts;
+    m_em1_counts = 0;
+    m_em2_counts = 0;
+    m_stats_start = now;
+    __set_PRIMASK(primask);
+
+    stats->em0_ms = (uint64_t)(total - em1 - em2) * 1000 / IDLE_RTCC_HZ;
+    stats->em1_ms = (uint64_t)em1 * 1000 / IDLE_RTCC_HZ;
+    stats->em2_ms = (uint64_t)em2 * 1000 / IDLE_RTCC_HZ;
+}
+
+// Wait for the next count, at most 1/32768 s. Reads at count edges measure
+// the sleep in whole counts wherever in a count it starts and ends.
+static uint32_t rtcc_edge (void)
+{
+    uint32_t count = RTCC_CounterGet();
+    uint32_t next;
+
+    while ((next = RTCC_CounterGet()) == count)
+    {
+    }
+    return next;
+}
+
+static bool em2_allowed (TickType_t ticks)
+{
+    if ((m_em2_block > 0) || (ticks < IDLE_EM2_MIN_TICKS))
+    {
+        return false;
+    }
+#ifdef RETARGET_UART
+    // Let the last log character leave the UART, it stops in EM2
+    if ((RETARGET_UART->STATUS & USART_STATUS_TXC) == 0)
+    {
+        return false;
+    }
+#endif//RETARGET_UART
+    return true;
+}
+
+void vPortSuppressTicksAndSleep (TickType_t expected_ticks)
+{
+    if (expected_ticks > IDLE_MAX_TICKS)
+    {
+        expected_ticks = IDLE_MAX_TICKS;
+    }
+
+    __disable_irq();
+    __DSB();
+    __ISB();
+
+    if (eTaskConfirmSleepModeStatus() == eAbortSleep)
+    {
+        __enable_irq();
+        return;
+    }
+
+    // SysTick counts on until the count edge. If it wraps meanwhile, the
+    // tick interrupt is pending and the sleep is left to the next call.
+    uint32_t before = SysTick->VAL;
+    uint32_t start = rtcc_edge();
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+    if (SysTick->VAL > before)
+    {
+        SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+        __enable_irq();
+        return;
+    }
+
+    // Cycles of the current tick that SysTick has counted. Times below are
+    // in cycles * IDLE_RTCC_HZ, where a count is period * configTICK_RATE_HZ.
+    uint32_t period = SysTick->LOAD + 1;
+    uint32_t counted = SysTick->LOAD - SysTick->VAL;
+    uint64_t count_time = (uint64_t)period * configTICK_RATE_HZ;
+    uint64_t tick_time = (uint64_t)period * IDLE_RTCC_HZ;
+
+    // Wake up at the start of the last tick, SysTick gives that one, rounded
+    // up to a whole count so that the steps reach it
+    uint64_t target = (uint64_t)(expected_ticks - 1) * tick_time;
+    uint64_t now = (uint64_t)counted * IDLE_RTCC_HZ;
+    uint32_t sleep_counts = 0;
+    if (target > now)
+    {
+        sleep_counts = (uint32_t)((target - now + count_time - 1) / count_time);
+    }
+    bool em2 = em2_allowed(expected_ticks);
+
+    RTCC_IntClear(RTCC_IF_CC1);
+    RTCC_ChannelCCVSet(IDLE_RTCC_CC, start + (sleep_counts > 0 ? sleep_counts : 1));
+
+    if (em2)
+    {
+        EMU_EnterEM2(true);
+    }
+    else
+    {
+        EMU_EnterEM1();
+    }
+
+    // SysTick restarts at a count edge too
+    uint32_t counts = rtcc_edge() - start;
+    if (em2)
+    {
+        m_em2_counts += counts;
+    }
+    else
+    {
+        m_em1_counts += counts;
+    }
+
+    // The last tick is left to SysTick, which restarts with the rest of the
+    // tick that the time is in, or at once when the time is past the last
+    // tick start, a wake-up that late loses the time beyond it
+    uint64_t total = now + (uint64_t)counts * count_time;
+    uint32_t ticks = (uint32_t)(total / tick_time);
+    uint32_t rest = 0;
+    if (ticks > expected_ticks - 1)
+    {
+        ticks = expected_ticks - 1;
+    }
+    else
+    {
+        rest = period - (uint32_t)((total - ticks * tick_time + IDLE_RTCC_HZ / 2) / IDLE_RTCC_HZ);
+    }
+    if (rest < 2)
+    {
+        rest = 2;
+    }
+
+    // Like the FreeRTOS port, the full period is loaded back after SysTick
+    // has started, it takes effect from the next reload
+    SysTick->LOAD = rest - 1;
+    SysTick->VAL = 0;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+    vTaskStepTick(ticks);
+    SysTick->LOAD = period - 1;
+
+    __enable_irq();
+}
+
+#endif//configUSE_TICKLESS_IDLE
@@ -0,0 +1,53 @@
+/**
+ * @brief Tickless idle with EM2 sleep. When all threads wait, the kernel
+ * tick is stopped and the RTCC, running from the 32.768kHz LFXO, wakes the
+ * core for the next deadline. If the deadline is far enough away and no
+ * driver needs the high frequency clocks, the core sleeps in EM2.
+ *
+ * Drivers that use high frequency peripherals, which stop in EM2, must
+ * hold an EM2 block while they are active. GPIO edge interrupts and RTOS
+ * timers keep working in EM2.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef IDLE_H_
+#define IDLE_H_
+
+#include <stdint.h>
+
+// Minimum expected idle time in ticks for going to EM2, shorter idle
+// periods are spent in EM1 because of the HFXO restart time
+#ifndef IDLE_EM2_MIN_TICKS
+#define IDLE_EM2_MIN_TICKS 5
+#endif//IDLE_EM2_MIN_TICKS
+
+typedef struct
+{
+    uint32_t em0_ms; // Running
+    uint32_t em1_ms; // Sleeping in EM1
+    uint32_t em2_ms; // Sleeping in EM2
+} idle_stats_t;
+
+/**
+ * Set up the RTCC wake-up source, call before starting the kernel.
+ * Only available with configUSE_TICKLESS_IDLE=2, as is idle_stats().
+ */
+void idle_init (void);
+
+/**
+ * Keep the core out of EM2, calls nest. May be called from interrupts.
+ */
+void idle_em2_block (void);
+
+/**
+ * Release an EM2 block.
+ */
+void idle_em2_unblock (void);
+
+/**
+ * Get the time spent in each energy mode since the previous call.
+ */
+void idle_stats (idle_stats_t * stats);
+
+#endif//IDLE_H_
@@ -0,0 +1,254 @@
+/**
+ * @brief Image CRC with GPCRC and LDMA, or slice-by-8 in software. The
+ * software CRC is also the fallback when GPCRC fails its check.
+ *
+ * GPCRC shifts data in least significant bit first, so CCITT input bytes
+ * are bit reversed on the way in and the result is read bit reversed.
+ * The data is moved with LDMA in 32-bit words, up to the LDMA transfer
+ * count per descriptor, the unaligned head and tail are written by the CPU.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include "imagecrc.h"
+
+#include <stddef.h>
+
+#include "em_device.h"
+#include "em_cmu.h"
+
+#if defined(GPCRC_PRESENT) && !IMAGECRC_SOFTWARE
+#define IMAGECRC_GPCRC 1
+#include "em_gpcrc.h"
+#include "em_ldma.h"
+#else
+#define IMAGECRC_GPCRC 0
+#endif
+
+#define IMAGECRC_POLY       0x1021
+#define IMAGECRC_CHECK      0x29B1 // CRC of "123456789"
+#define IMAGECRC_LDMA_CH    0
+#define IMAGECRC_LDMA_MAX   2048   // Transfer units per descriptor
+
+// From the linker script, data is loaded from flash right after the code
+extern const uint32_t __etext;
+extern uint32_t __data_start__;
+extern uint32_t __data_end__;
+
+static bool m_hardware;
+
+// Bitwise reference, builds the tables
+static uint16_t crc_bitwise (uint16_t crc, const uint8_t * p, uint32_t len)
+{
+    while (len--)
+    {
+        crc ^= (uint16_t)(*p++) << 8;
+        for (uint8_t b = 0; b < 8; b++)
+        {
+            crc = (crc & 0x8000) ? (crc << 1) ^ IMAGECRC_POLY : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+// Table k holds the CRC of a byte followed by k zero bytes
+static uint16_t m_table[8][256];
+static bool m_table_ready;
+
+static void table_init (void)
+{
+    for (uint16_t n = 0; n < 256; n++)
+    {
+        uint8_t byte = (uint8_t)n;
+        m_table[0][n] = crc_bitwise(0, &byte, 1);
+    }
+    for (uint16_t n = 0; n < 256; n++)
+    {
+        for (uint8_t k = 1; k < 8; k++)
+        {
+            uint16_t prev = m_table[k - 1][n];
+            m_table[k][n] = (uint16_t)(prev << 8) ^ m_table[0][prev >> 8];
+        }
+    }
+    m_table_ready = true;
+}
+
+// One lookup per byte
+static uint16_t crc_table (uint16_t crc, const uint8_t * p, uint32_t len)
+{
+    if (!m_table_ready)
+    {
+        table_init();
+    }
+
+    while (len--)
+    {
+        crc = (uint16_t)(crc << 8) ^ m_table[0][(crc >> 8) ^ *p++];
+    }
+    return crc;
+}
+
+static uint16_t crc_slice4 (uint16_t crc, const uint8_t * p, uint32_t len)
+{
+    if (!m_table_ready)
+    {
+        table_init();
+    }
+
+    for (; len >= 4; len -= 4, p += 4)
+    {
+        crc ^= ((uint16_t)p[0] << 8) | p[1];
+        crc = m_table[3][crc >> 8] ^ m_table[2][crc & 0xFF] ^ m_table[1][p[2]] ^ m_table[0][p[3]];
+    }
+    return crc_table(crc, p, len);
+}
+
+static uint16_t crc_slice8 (uint16_t crc, const uint8_t * p, uint32_t len)
+{
+    if (!m_table_ready)
+    {
+        table_init();
+    }
+
+    for (; len >= 8; len -= 8, p += 8)
+    {
+        crc ^= ((uint16_t)p[0] << 8) | p[1];
+        crc = m_table[7][crc >> 8] ^ m_table[6][crc & 0xFF]
+            ^ m_table[5][p[2]] ^ m_table[4][p[3]] ^ m_table[3][p[4]]
+            ^ m_table[2][p[5]] ^ m_table[1][p[6]] ^ m_table[0][p[7]];
+    }
+    return crc_table(crc, p, len);
+}
+
+#if IMAGECRC_GPCRC
+// Feed an area to a started GPCRC
+static void gpcrc_input (const uint8_t * p, uint32_t len)
+{
+    for (; (len > 0) && (((uintptr_t)p & 3) != 0); len--)
+    {
+        GPCRC_InputU8(GPCRC, *p++);
+    }
+
+    while (len >= 4)
+    {
+        uint32_t words = len / 4;
+        if (words > IMAGECRC_LDMA_MAX)
+        {
+            words = IMAGECRC_LDMA_MAX;
+        }
+
+        LDMA_TransferCfg_t cfg = LDMA_TRANSFER_CFG_MEMORY();
+        LDMA_Descriptor_t desc = LDMA_DESCRIPTOR_SINGLE_M2M_WORD(p, &GPCRC->INPUTDATA, words);
+        desc.xfer.dstInc = ldmaCtrlDstIncNone;
+        desc.xfer.doneIfs = 0;
+
+        LDMA_StartTransfer(IMAGECRC_LDMA_CH, &cfg, &desc);
+        while (!LDMA_TransferDone(IMAGECRC_LDMA_CH));
+
+        p += words * 4;
+        len -= words * 4;
+    }
+
+    while (len--)
+    {
+        GPCRC_InputU8(GPCRC, *p++);
+    }
+}
+
+static uint16_t crc_gpcrc (const uint8_t * p, uint32_t len)
+{
+    GPCRC_Start(GPCRC);
+    gpcrc_input(p, len);
+    return (uint16_t)GPCRC_DataReadBitReversed(GPCRC);
+}
+#endif//IMAGECRC_GPCRC
+
+bool imagecrc_init (void)
+{
+#if IMAGECRC_GPCRC
+    static const uint8_t check[] = "123456789";
+
+    CMU_ClockEnable(cmuClock_GPCRC, true);
+    CMU_ClockEnable(cmuClock_LDMA, true);
+
+    GPCRC_Init_TypeDef init = GPCRC_INIT_DEFAULT;
+    init.crcPoly = IMAGECRC_POLY;
+    init.initValue = IMAGECRC_INIT;
+    init.reverseBits = true;
+    GPCRC_Init(GPCRC, &init);
+
+    LDMA_Init_t ldma = LDMA_INIT_DEFAULT;
+    LDMA_Init(&ldma);
+
+    m_hardware = (crc_gpcrc(check, sizeof(check) - 1) == IMAGECRC_CHECK);
+#else
+    m_hardware = false;
+#endif//IMAGECRC_GPCRC
+    return m_hardware;
+}
+
+uint16_t imagecrc_compute (const void *data, uint32_t len)
+{
+#if IMAGECRC_GPCRC
+    if (m_hardware)
+    {
+        return crc_gpcrc(data, len);
+    }
+#endif//IMAGECRC_GPCRC
+    return crc_slice8(IMAGECRC_INIT, data, len);
+}
+
+uint16_t imagecrc_compute_skip (const void *data, uint32_t len, const void *skip, uint32_t skip_len)
+{
+    const uint8_t * p = data;
+    uintptr_t head = (uintptr_t)skip - (uintptr_t)data;
+
+    // A hole outside of the area is not skipped, one running past the end is cut
+    if ((skip == NULL) || ((uintptr_t)skip < (uintptr_t)data) || (head >= len))
+    {
+        return imagecrc_compute(data, len);
+    }
+    if (skip_len > len - head)
+    {
+        skip_len = (uint32_t)(len - head);
+    }
+
+#if IMAGECRC_GPCRC
+    if (m_hardware)
+    {
+        GPCRC_Start(GPCRC);
+        gpcrc_input(p, (uint32_t)head);
+        gpcrc_input(p + head + skip_len, (uint32_t)(len - head - skip_len));
+        return (uint16_t)GPCRC_DataReadBitReversed(GPCRC);
+    }
+#endif//IMAGECRC_GPCRC
+    uint16_t crc = crc_slice8(IMAGECRC_INIT, p, (uint32_t)head);
+    return crc_slice8(crc, p + head + skip_len, (uint32_t)(len - head - skip_len));
+}
+
+uint16_t imagecrc_compute_method (imagecrc_method_t method, const void *data, uint32_t len)
+{
+    switch (method)
+    {
+        case IMAGECRC_BITWISE:
+            return crc_bitwise(IMAGECRC_INIT, data, len);
+        case IMAGECRC_TABLE:
+            return crc_table(IMAGECRC_INIT, data, len);
+        case IMAGECRC_SLICE4:
+            return crc_slice4(IMAGECRC_INIT, data, len);
+        case IMAGECRC_SLICE8:
+        default:
+            return crc_slice8(IMAGECRC_INIT, data, len);
+    }
+}
+
+const void * imagecrc_image_start (void)
+{
+    return (const void *)VTOR_START_LOCATION;
+}
+
+uint32_t imagecrc_image_size (void)
+{
+    uint32_t data = (uint32_t)((uintptr_t)&__data_end__ - (uintptr_t)&__data_start__);
+    return (uint32_t)((uintptr_t)&__etext - VTOR_START_LOCATION) + data;
+}
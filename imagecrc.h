@@ -0,0 +1,90 @@
+/**
+ * @brief CRC-16/CCITT of the application image, the variant HEADEREDIT
+ * stamps into the header: polynomial 0x1021, initial value 0xFFFF, no
+ * reflection and no final XOR.
+ *
+ * The GPCRC peripheral fed by LDMA is used when the device has one and
+ * passes its check, otherwise a slice-by-8 software CRC with 4kB of tables
+ * in RAM, built on first use.
+ *
+ * The header HEADEREDIT stamps the CRC into is embedded in the image, so
+ * the image CRC is computed with the header left out. The firmware build
+ * checks every stamped .bin with 'appheader_check -i', which fails if
+ * HEADEREDIT covered another range.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef IMAGECRC_H_
+#define IMAGECRC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define IMAGECRC_INIT 0xFFFF
+
+// Software methods, the table ones share the slice-by-8 tables
+typedef enum
+{
+    IMAGECRC_BITWISE,
+    IMAGECRC_TABLE,  // One 256-entry table lookup per byte
+    IMAGECRC_SLICE4,
+    IMAGECRC_SLICE8
+} imagecrc_method_t;
+
+// Set to use the software CRC also when GPCRC is present
+#ifndef IMAGECRC_SOFTWARE
+#define IMAGECRC_SOFTWARE 0
+#endif//IMAGECRC_SOFTWARE
+
+/**
+ * Prepare the CRC engine and check GPCRC against the reference value of
+ * the standard check string, the software CRC is used on mismatch.
+ *
+ * @return true if the hardware engine is used.
+ */
+bool imagecrc_init (void);
+
+/**
+ * Compute the CRC of a memory area, blocks until done.
+ *
+ * @param data Start of the area, any alignment.
+ * @param len  Length in bytes.
+ * @return CRC starting from IMAGECRC_INIT.
+ */
+uint16_t imagecrc_compute (const void *data, uint32_t len);
+
+/**
+ * Compute the CRC of a memory area with a hole left out, blocks until done.
+ *
+ * @param data     Start of the area, any alignment.
+ * @param len      Length in bytes.
+ * @param skip     Start of the hole, NULL or outside of the area for none.
+ * @param skip_len Length of the hole in bytes, cut at the end of the area.
+ * @return CRC starting from IMAGECRC_INIT of the bytes around the hole.
+ */
+uint16_t imagecrc_compute_skip (const void *data, uint32_t len, const void *skip, uint32_t skip_len);
+
+/**
+ * Compute the CRC of a memory area with a given software method, for
+ * comparing them.
+ *
+ * @param method Software method.
+ * @param data   Start of the area, any alignment.
+ * @param len    Length in bytes.
+ * @return CRC starting from IMAGECRC_INIT.
+ */
+uint16_t imagecrc_compute_method (imagecrc_method_t method, const void *data, uint32_t len);
+
+/**
+ * @return Start of the application image in flash.
+ */
+const void * imagecrc_image_start (void);
+
+/**
+ * @return Length of the application image in flash as written to the
+ *         .bin file, the code and the initial values of data.
+ */
+uint32_t imagecrc_image_size (void);
+
+#endif//IMAGECRC_H_
@@ -0,0 +1,114 @@
+/**
+ * @brief Latency trace buffers and statistics.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include "latency.h"
+
+#include <string.h>
+#include <inttypes.h>
+
+#include "cmsis_os2.h"
+
+#include "loglevels.h"
+#define __MODUUL__ "lat"
+#define __LOG_LEVEL__ (LOG_LEVEL_latency & BASE_LOG_LEVEL)
+#include "log.h"
+
+#define LATENCY_HIST_BINS 32 // Bin n counts samples of [2^(n-1), 2^n) time units, the last one all above
+
+typedef struct
+{
+    uint32_t samples[LATENCY_TRACE_LEN];
+    uint32_t count; // Total samples, the buffer holds the last LATENCY_TRACE_LEN
+    uint32_t hist[LATENCY_HIST_BINS];
+} latency_trace_t;
+
+static const char * const m_names[LATENCY_CHANNELS] = { "button-tone", "tick-led" };
+
+volatile uint32_t latency_started[LATENCY_CHANNELS];
+
+static latency_trace_t m_traces[LATENCY_CHANNELS];
+
+// Copy of one channel, sorted for the report
+static uint32_t m_sorted[LATENCY_TRACE_LEN];
+static uint32_t m_hist[LATENCY_HIST_BINS];
+
+void latency_stop (latency_channel_t channel)
+{
+    uint32_t now = LATENCY_TIME();
+    uint32_t start = __atomic_exchange_n(&latency_started[channel], 0, __ATOMIC_RELAXED);
+
+    if (start != 0)
+    {
+        latency_trace_t * trace = &m_traces[channel];
+        uint32_t elapsed = now - start;
+
+        trace->samples[trace->count % LATENCY_TRACE_LEN] = elapsed;
+        uint32_t bin = (elapsed != 0) ? 32 - __builtin_clz(elapsed) : 0;
+        trace->hist[bin < LATENCY_HIST_BINS ? bin : LATENCY_HIST_BINS - 1]++;
+        __atomic_store_n(&trace->count, trace->count + 1, __ATOMIC_RELEASE);
+    }
+}
+
+static void sort (uint32_t * v, uint32_t n)
+{
+    for (uint32_t i = 1; i < n; i++)
+    {
+        uint32_t x = v[i];
+        uint32_t j = i;
+        for (; (j > 0) && (v[j - 1] > x); j--)
+        {
+            v[j] = v[j - 1];
+        }
+        v[j] = x;
+    }
+}
+
+static uint32_t to_us (uint32_t t, uint32_t hz)
+{
+    return (uint32_t)((uint64_t)t * 1000000 / hz);
+}
+
+void latency_report (void)
+{
+    uint32_t hz = LATENCY_TIME_HZ;
+
+    for (uint8_t c = 0; c < LATENCY_CHANNELS; c++)
+    {
+        int32_t lock = osKernelLock();
+        uint32_t count = m_traces[c].count;
+        memcpy(m_sorted, m_traces[c].samples, sizeof(m_sorted));
+        memcpy(m_hist, m_traces[c].hist, sizeof(m_hist));
+        osKernelRestoreLock(lock);
+
+        uint32_t n = count < LATENCY_TRACE_LEN ? count : LATENCY_TRACE_LEN;
+        if (n == 0)
+        {
+            info1("%s: no samples", m_names[c]);
+            continue;
+        }
+
+        sort(m_sorted, n);
+        uint64_t sum = 0;
+        for (uint32_t i = 0; i < n; i++)
+        {
+            sum += m_sorted[i];
+        }
+        uint32_t p99 = m_sorted[(n * 99 - 1) / 100];
+
+        info1("%s: %"PRIu32" samples, last %"PRIu32" min/avg/p99/max %"PRIu32"/%"PRIu32"/%"PRIu32"/%"PRIu32" us, %"PRIu32" Hz",
+              m_names[c], count, n, to_us(m_sorted[0], hz), to_us((uint32_t)(sum / n), hz),
+              to_us(p99, hz), to_us(m_sorted[n - 1], hz), hz);
+
+        // Bins in time units of the timebase
+        for (uint8_t b = 0; b < LATENCY_HIST_BINS; b++)
+        {
+            if (m_hist[b] != 0)
+            {
+                info1("%s: <%10"PRIu32" %"PRIu32, m_names[c], b < 31 ? (uint32_t)1 << b : UINT32_MAX, m_hist[b]);
+            }
+        }
+    }
+}
@@ -0,0 +1,87 @@
+/**
+ * @brief Event-to-action latency measurement.
+ *
+ * A channel is started at the triggering event and stopped at the GPIO
+ * action it causes, the difference is kept in a fixed size trace buffer.
+ * Without LATENCY_TRACE all calls compile to nothing.
+ *
+ * Times come from the DWT cycle counter, or from the RTCC with tickless
+ * idle since the core clock and the cycle counter stop in sleep, like in
+ * gpiotrace.h. The RTCC resolution is 1/32768 s. LATENCY_TIME can be
+ * redefined together with LATENCY_TIME_HZ to use another clock.
+ *
+ * Channels:
+ *  - LATENCY_BUTTON_TONE from button.c reporting a short press to the PA0
+ *    tone starting. The debounce and the double-click window are over by
+ *    then and the bounces do not restart it.
+ *  - LATENCY_TICK_LED from the kernel tick that makes an LED pattern
+ *    deadline due to the PB12 green LED changing state.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef LATENCY_H_
+#define LATENCY_H_
+
+#include <stdint.h>
+
+typedef enum
+{
+    LATENCY_BUTTON_TONE,
+    LATENCY_TICK_LED,
+    LATENCY_CHANNELS
+} latency_channel_t;
+
+#ifdef LATENCY_TRACE
+
+// Samples kept per channel, the oldest ones are overwritten
+#ifndef LATENCY_TRACE_LEN
+#define LATENCY_TRACE_LEN 64
+#endif//LATENCY_TRACE_LEN
+
+#ifndef LATENCY_TIME
+#if configUSE_TICKLESS_IDLE == 2
+#include "em_rtcc.h"
+#define LATENCY_TIME()   RTCC_CounterGet()
+#define LATENCY_TIME_HZ  32768UL
+#else
+#include "em_cmu.h"
+#include "cycles.h"
+#define LATENCY_TIME()   cycles_now()
+#define LATENCY_TIME_HZ  CMU_ClockFreqGet(cmuClock_CORE)
+#endif//configUSE_TICKLESS_IDLE
+#endif//LATENCY_TIME
+
+extern volatile uint32_t latency_started[LATENCY_CHANNELS];
+
+/**
+ * Mark the triggering event of a channel, safe in interrupts.
+ * A later start replaces an earlier one that was not stopped.
+ */
+static inline void latency_start (latency_channel_t channel)
+{
+    latency_started[channel] = LATENCY_TIME() | 1; // 0 means not started
+}
+
+/**
+ * Mark the action on a channel and record the latency from the last start,
+ * ignored if the channel was not started. Stops on one channel must not
+ * run concurrently.
+ */
+void latency_stop (latency_channel_t channel);
+
+/**
+ * Log min/avg/p99/max of the buffered samples and a log2 histogram of all
+ * samples of each channel.
+ */
+void latency_report (void);
+
+#else
+
+#define latency_start(channel)
+#define latency_stop(channel)
+#define latency_report()
+
+#endif//LATENCY_TRACE
+
+#endif//LATENCY_H_
@@ -0,0 +1,213 @@
+/**
+ * @brief LED pattern engine on a single one-shot RTOS timer.
+ *
+ * Each LED has its own position in its pattern and the tick of its next
+ * transition. The timer callback advances every LED that is due, applies
+ * the new states with one leds_set_masked_locked() call and restarts the timer
+ * for the earliest upcoming transition. A breathing flash is split into
+ * 2^LEDPAT_BREATHE_SHIFT transitions that step the LED brightness.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include "ledpat.h"
+
+#include "cmsis_os2.h"
+#include "FreeRTOS.h"
+
+#include "leds.h"
+#include "latency.h"
+
+#define LEDPAT_BREATHE_STEPS (1 << LEDPAT_BREATHE_SHIFT)
+
+// Rising half of the breathing curve, (1 - cos(pi * x)) / 2 with gamma 2.2
+static const uint8_t m_breathe_curve[LEDPAT_BREATHE_STEPS / 2] = {
+      0,   0,   0,   0,   0,   1,   1,   2,   4,   7,  11,  15,  22,  29,  39,  50,
+     62,  76,  91, 107, 124, 141, 159, 176, 192, 207, 221, 233, 242, 249, 254, 255
+};
+
+typedef struct
+{
+    ledpat_t pattern;
+    uint32_t deadline; // Tick of the next transition
+    uint8_t flash;     // Flash number in the cycle
+    uint8_t step;      // Breathing step in the flash
+    uint8_t level;     // Current brightness
+    bool on;
+    bool active;
+} ledpat_led_t;
+
+static ledpat_led_t m_leds[LEDS_COUNT];
+static osTimerId_t m_timer;
+static StaticTimer_t m_timer_cb;
+
+static uint32_t ms_to_ticks (uint32_t ms)
+{
+    return ms * osKernelGetTickFreq() / 1000;
+}
+
+// Move the LED to its next state, returns the time spent in it
+static uint32_t advance (ledpat_led_t * led)
+{
+    const ledpat_t * pat = &led->pattern;
+
+    if (led->on && pat->breathe && (led->step < LEDPAT_BREATHE_STEPS - 1))
+    {
+        led->step++;
+        return pat->on_ms >> LEDPAT_BREATHE_SHIFT;
+    }
+
+    if (led->on)
+    {
+        led->on = false;
+        led->flash++;
+        if (led->flash < pat->count)
+        {
+            return pat->off_ms;
+        }
+        if (pat->once)
+        {
+            led->active = false;
+            return 0;
+        }
+        return pat->off_ms + pat->pause_ms;
+    }
+
+    if (led->flash >= pat->count)
+    {
+        led->flash = 0;
+    }
+    led->on = true;
+    if (pat->breathe)
+    {
+        led->step = 0;
+        return pat->on_ms >> LEDPAT_BREATHE_SHIFT;
+    }
+    return pat->on_ms;
+}
+
+// Advance all due LEDs and reschedule the timer, called with kernel locked
+static void update (void)
+{
+    uint32_t now = osKernelGetTickCount();
+    uint32_t next = UINT32_MAX;
+    uint8_t mask = 0;
+    uint8_t pattern = 0;
+
+    for (uint8_t i = 0; i < LEDS_COUNT; i++)
+    {
+        ledpat_led_t * led = &m_leds[i];
+
+        if (!led->active)
+        {
+            continue;
+        }
+
+        // Zero-length states are passed through without being displayed
+        while (led->active && ((int32_t)(led->deadline - now) <= 0))
+        {
+            led->deadline += ms_to_ticks(advance(led));
+        }
+
+        mask |= (1 << i);
+        if (led->on)
+        {
+            pattern |= (1 << i);
+        }
+
+        if (led->on && led->pattern.breathe)
+        {
+            uint8_t s = led->step;
+            uint8_t level = m_breathe_curve[s < LEDPAT_BREATHE_STEPS / 2 ? s : LEDPAT_BREATHE_STEPS - 1 - s];
+            if (level != led->level)
+            {
+                led->level = level;
+                leds_brightness_set_locked(1 << i, level);
+            }
+        }
+
+        if (led->active)
+        {
+            uint32_t wait = led->deadline - now;
+            if (wait < next)
+            {
+                next = wait;
+            }
+        }
+    }
+
+    leds_set_masked_locked(mask, pattern);
+
+    if (next != UINT32_MAX)
+    {
+        osTimerStart(m_timer, next > 0 ? next : 1);
+    }
+    else
+    {
+        osTimerStop(m_timer);
+    }
+}
+
+static void ledpat_timeout (void *argument)
+{
+    int32_t lock = osKernelLock();
+    uint8_t before = leds_get();
+    update();
+    if ((before ^ leds_get()) & LEDS_GREEN)
+    {
+        latency_stop(LATENCY_TICK_LED);
+    }
+    osKernelRestoreLock(lock);
+}
+
+void ledpat_init (void)
+{
+    const osTimerAttr_t timer_attr = { .name = "ledpat", .cb_mem = &m_timer_cb, .cb_size = sizeof(m_timer_cb) };
+    m_timer = osTimerNew(ledpat_timeout, osTimerOnce, NULL, &timer_attr);
+}
+
+void ledpat_start (uint8_t leds, const ledpat_t * pattern)
+{
+    int32_t lock = osKernelLock();
+    uint32_t now = osKernelGetTickCount();
+    uint32_t on_ms = pattern->on_ms;
+    if (pattern->breathe)
+    {
+        on_ms = (on_ms >> LEDPAT_BREATHE_SHIFT) << LEDPAT_BREATHE_SHIFT;
+    }
+
+    for (uint8_t i = 0; i < LEDS_COUNT; i++)
+    {
+        if (leds & (1 << i))
+        {
+            m_leds[i].pattern = *pattern;
+            m_leds[i].flash = 0;
+            m_leds[i].on = false;
+            m_leds[i].level = LEDS_LEVEL_MAX;
+            m_leds[i].deadline = now;
+            // A repeating pattern must take time, or it would never yield
+            m_leds[i].active = (pattern->count > 0)
+                               && (pattern->once || (ms_to_ticks(on_ms + pattern->off_ms + pattern->pause_ms) > 0));
+        }
+    }
+    leds_brightness_set_locked(leds, LEDS_LEVEL_MAX);
+    leds_set_masked_locked(leds, 0);
+    update();
+    osKernelRestoreLock(lock);
+}
+
+void ledpat_stop (uint8_t leds)
+{
+    int32_t lock = osKernelLock();
+
+    for (uint8_t i = 0; i < LEDS_COUNT; i++)
+    {
+        if (leds & (1 << i))
+        {
+            m_leds[i].active = false;
+        }
+    }
+    leds_set_masked_locked(leds, 0);
+    update();
+    osKernelRestoreLock(lock);
+}
@@ -0,0 +1,66 @@
+/**
+ * @brief LED pattern engine. Any number of LEDs are driven from pattern
+ * descriptors by a single RTOS timer, so blinking LEDs need no threads.
+ * The timer is restarted for the next LED transition only, it does not
+ * tick while nothing changes.
+ *
+ * A pattern is a cycle of count flashes of on_ms followed by off_ms, then
+ * a pause of pause_ms. The cycle repeats forever or is played only once.
+ * Breathing flashes fade in and out along a gamma corrected curve instead
+ * of switching the LED fully on.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef LEDPAT_H_
+#define LEDPAT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct
+{
+    uint16_t on_ms;    // Flash length
+    uint16_t off_ms;   // Time between flashes
+    uint16_t pause_ms; // Time after the last flash of the cycle
+    uint8_t count;     // Number of flashes in a cycle
+    bool once;         // Play the cycle once, LED stays off afterwards
+    bool breathe;      // Fade flashes in and out
+} ledpat_t;
+
+// Periodic on/off blinking
+#define LEDPAT_BLINK(on_ms, off_ms) { (on_ms), (off_ms), 0, 1, false, false }
+// A single flash
+#define LEDPAT_PULSE(on_ms)         { (on_ms), 0, 0, 1, true, false }
+// Double flash once a second
+#define LEDPAT_HEARTBEAT            { 100, 150, 650, 2, false, false }
+// Flashes count times and pauses, for displaying error and status codes
+#define LEDPAT_FLASH_CODE(count)    { 200, 300, 1500, (count), false, false }
+// Continuous fade in and out
+#define LEDPAT_BREATHE(period_ms)   { (period_ms), 0, 0, 1, false, true }
+
+#define LEDPAT_BREATHE_SHIFT 6 // 2^6 brightness steps per breathing flash
+
+/**
+ * Initialize the pattern engine, leds_init() must have been called.
+ */
+void ledpat_init (void);
+
+/**
+ * Start a pattern on LEDs, replacing their current patterns.
+ * The LEDs start their cycles together with the first flash and
+ * their brightness is reset to full.
+ *
+ * @param leds    LEDS_ bits of the LEDs.
+ * @param pattern Pattern descriptor, it is copied.
+ */
+void ledpat_start (uint8_t leds, const ledpat_t * pattern);
+
+/**
+ * Stop patterns on LEDs and turn the LEDs off.
+ *
+ * @param leds LEDS_ bits of the LEDs.
+ */
+void ledpat_stop (uint8_t leds);
+
+#endif//LEDPAT_H_
@@ -0,0 +1,345 @@
+/**
+ * @brief LED driver with one register write per port and PWM brightness.
+ *
+ * EFR32 series 1 GPIO has no DOUTSET/DOUTCLR registers, but DOUTTGL
+ * flips any set of pins on a port with one store. The driver keeps the
+ * LED pin state itself and writes the difference between the current and
+ * the new state to DOUTTGL, so other pins on the port are never touched
+ * and no read-modify-write of DOUT is needed.
+ *
+ * Brightness is generated with TIMER1. LEDs that have a compare output
+ * location use hardware PWM, the rest use software PWM: the overflow
+ * interrupt turns all of them on and compare channel 3 is stepped through
+ * the sorted brightness levels to turn them off, so the interrupt runs at
+ * most once per distinct level and writes each port once. Full and zero
+ * brightness are plain GPIO levels and need no timer.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include "leds.h"
+
+#include <stdbool.h>
+
+#include "cmsis_os2.h"
+
+#include "em_cmu.h"
+#include "em_gpio.h"
+#include "em_timer.h"
+
+#include "pins.h"
+#include "idle.h"
+#include "gpiotrace.h"
+
+// Set to use software PWM for all LEDs, leaves the TIMER1 outputs free
+#ifndef LEDS_SOFT_PWM
+#define LEDS_SOFT_PWM 0
+#endif//LEDS_SOFT_PWM
+
+#define LEDS_PWM_TIMER       TIMER1
+#define LEDS_PWM_TIMER_CLOCK cmuClock_TIMER1
+#define LEDS_PWM_IRQn        TIMER1_IRQn
+#define LEDS_PWM_PRESC       timerPrescale256 // 586Hz PWM from 38.4MHz
+#define LEDS_PWM_TOP         (LEDS_LEVEL_MAX)
+#define LEDS_SOFT_CC         3                // Compare channel without output
+#define LEDS_CC_NONE         0xFF
+
+#if LEDS_SOFT_PWM
+#define LEDS_CC(cc) LEDS_CC_NONE
+#else
+#define LEDS_CC(cc) (cc)
+#endif//LEDS_SOFT_PWM
+
+typedef struct
+{
+    GPIO_Port_TypeDef port;
+    uint8_t pin;
+    uint8_t cc;  // TIMER1 compare channel, LEDS_CC_NONE for software PWM
+    uint8_t loc; // Compare output location of the pin
+} led_pin_t;
+
+typedef struct
+{
+    GPIO_Port_TypeDef port;
+    uint8_t leds;              // LEDS_ bits on this port
+    uint32_t pins[LEDS_COUNT]; // Port pin mask of each LED, 0 if elsewhere
+} led_port_t;
+
+// In LEDS_ bit order
+static const led_pin_t m_leds[LEDS_COUNT] = {
+    { PIN_LED_RED,   LEDS_CC(0), 6 }, // TIM1_CC0 #6
+    { PIN_LED_GREEN, LEDS_CC(1), 6 }, // TIM1_CC1 #6
+    { PIN_LED_BLUE,  LEDS_CC(2), 3 }, // TIM1_CC2 #3
+};
+
+static led_port_t m_ports[LEDS_COUNT];
+static uint8_t m_port_count;
+
+static bool m_timer_running;
+static uint8_t m_state;                // LEDs that are on
+static uint8_t m_level[LEDS_COUNT];    // Brightness of each LED when on
+static volatile uint8_t m_out;         // LEDs with their pin high
+
+// Software PWM schedule, used by the interrupt while it is enabled
+static uint8_t m_soft_leds;             // LEDs under software PWM
+static uint8_t m_soft_count;            // Number of distinct levels
+static uint8_t m_soft_level[LEDS_COUNT]; // Ascending levels
+static uint8_t m_soft_off[LEDS_COUNT];   // LEDs that turn off at each level
+static volatile uint8_t m_soft_next;
+
+// Toggle the pins of LEDs, one register write per port
+static void port_toggle (uint8_t leds)
+{
+    for (uint8_t p = 0; p < m_port_count; p++)
+    {
+        uint8_t on_port = leds & m_ports[p].leds;
+        uint32_t pins = 0;
+
+        for (uint8_t i = 0; on_port != 0; i++, on_port >>= 1)
+        {
+            if (on_port & 1)
+            {
+                pins |= m_ports[p].pins[i];
+            }
+        }
+        if (pins != 0)
+        {
+            GPIO_PortOutToggle(m_ports[p].port, pins);
+            gpiotrace_out(m_ports[p].port);
+        }
+    }
+}
+
+void leds_init (void)
+{
+    uint32_t routeloc = 0;
+
+    m_port_count = 0;
+    for (uint8_t i = 0; i < LEDS_COUNT; i++)
+    {
+        uint8_t p;
+
+        for (p = 0; p < m_port_count; p++)
+        {
+            if (m_ports[p].port == m_leds[i].port)
+            {
+                break;
+            }
+        }
+        if (p == m_port_count)
+        {
+            m_ports[p] = (led_port_t){ .port = m_leds[i].port };
+            m_port_count++;
+        }
+        m_ports[p].leds |= (1 << i);
+        m_ports[p].pins[i] = (1UL << m_leds[i].pin);
+
+        m_level[i] = LEDS_LEVEL_MAX;
+    }
+    m_state = 0;
+    m_out = 0;
+
+    CMU_ClockEnable(LEDS_PWM_TIMER_CLOCK, true);
+
+    TIMER_InitCC_TypeDef cc_init = TIMER_INITCC_DEFAULT;
+    for (uint8_t i = 0; i < LEDS_COUNT; i++)
+    {
+        if (m_leds[i].cc != LEDS_CC_NONE)
+        {
+            cc_init.mode = timerCCModePWM;
+            TIMER_InitCC(LEDS_PWM_TIMER, m_leds[i].cc, &cc_init);
+            routeloc |= (uint32_t)m_leds[i].loc << (m_leds[i].cc * _TIMER_ROUTELOC0_CC1LOC_SHIFT);
+        }
+    }
+    cc_init.mode = timerCCModeCompare;
+    TIMER_InitCC(LEDS_PWM_TIMER, LEDS_SOFT_CC, &cc_init);
+
+    TIMER_Init_TypeDef timer_init = TIMER_INIT_DEFAULT;
+    timer_init.enable = false;
+    timer_init.prescale = LEDS_PWM_PRESC;
+    TIMER_Init(LEDS_PWM_TIMER, &timer_init);
+    TIMER_TopSet(LEDS_PWM_TIMER, LEDS_PWM_TOP);
+
+    LEDS_PWM_TIMER->ROUTELOC0 = routeloc;
+    LEDS_PWM_TIMER->ROUTEPEN = 0;
+
+    NVIC_ClearPendingIRQ(LEDS_PWM_IRQn);
+}
+
+// Bring outputs in line with m_state and m_level, called with kernel locked
+static void apply (void)
+{
+    uint8_t high = 0;
+    uint8_t soft = 0;
+    uint32_t routepen = 0;
+
+    NVIC_DisableIRQ(LEDS_PWM_IRQn);
+
+    m_soft_count = 0;
+    for (uint8_t i = 0; i < LEDS_COUNT; i++)
+    {
+        uint8_t level = (m_state & (1 << i)) ? m_level[i] : 0;
+
+        if (level == LEDS_LEVEL_MAX)
+        {
+            high |= (1 << i);
+        }
+        else if (level == 0)
+        {
+            // Off
+        }
+        else if (m_leds[i].cc != LEDS_CC_NONE)
+        {
+            TIMER_CompareBufSet(LEDS_PWM_TIMER, m_leds[i].cc, level);
+            routepen |= (TIMER_ROUTEPEN_CC0PEN << m_leds[i].cc);
+        }
+        else
+        {
+            // Insert into the ascending software PWM schedule
+            uint8_t k = 0;
+            while ((k < m_soft_count) && (m_soft_level[k] < level))
+            {
+                k++;
+            }
+            if ((k == m_soft_count) || (m_soft_level[k] != level))
+            {
+                for (uint8_t j = m_soft_count; j > k; j--)
+                {
+                    m_soft_level[j] = m_soft_level[j - 1];
+                    m_soft_off[j] = m_soft_off[j - 1];
+                }
+                m_soft_level[k] = level;
+                m_soft_off[k] = 0;
+                m_soft_count++;
+            }
+            m_soft_off[k] |= (1 << i);
+            soft |= (1 << i);
+        }
+    }
+
+    // Software PWM LEDs are also taken low, they restart with the next period
+    port_toggle(m_out ^ high);
+    m_out = high;
+    m_soft_leds = soft;
+    m_soft_next = m_soft_count;
+
+    LEDS_PWM_TIMER->ROUTEPEN = routepen;
+
+    // The timer stops in EM2, dimmed LEDs keep the core in EM1
+    bool run = (routepen != 0) || (soft != 0);
+    if (run != m_timer_running)
+    {
+        TIMER_Enable(LEDS_PWM_TIMER, run);
+        if (run)
+        {
+            idle_em2_block();
+        }
+        else
+        {
+            idle_em2_unblock();
+        }
+        m_timer_running = run;
+    }
+
+    if (soft != 0)
+    {
+        TIMER_IntEnable(LEDS_PWM_TIMER, TIMER_IF_OF | (TIMER_IF_CC0 << LEDS_SOFT_CC));
+        NVIC_EnableIRQ(LEDS_PWM_IRQn);
+    }
+    else
+    {
+        TIMER_IntDisable(LEDS_PWM_TIMER, TIMER_IF_OF | (TIMER_IF_CC0 << LEDS_SOFT_CC));
+        TIMER_IntClear(LEDS_PWM_TIMER, TIMER_IF_OF | (TIMER_IF_CC0 << LEDS_SOFT_CC));
+    }
+}
+
+// Software PWM, turns LEDs on at overflow and off at their level. Both
+// flags are handled in one pass: the levels are taken from the counter, so
+// a compare pending together with the overflow or passed while the
+// interrupt waited still turns its LEDs off, and each port is written once.
+void TIMER1_IRQHandler (void)
+{
+    uint32_t flags = TIMER_IntGet(LEDS_PWM_TIMER) & LEDS_PWM_TIMER->IEN;
+    uint8_t out = m_out;
+
+    TIMER_IntClear(LEDS_PWM_TIMER, flags);
+
+    if (flags & TIMER_IF_OF)
+    {
+        out |= m_soft_leds;
+        m_soft_next = 0;
+    }
+    if (flags & (TIMER_IF_OF | (TIMER_IF_CC0 << LEDS_SOFT_CC)))
+    {
+        uint32_t count = TIMER_CounterGet(LEDS_PWM_TIMER);
+        while (m_soft_next < m_soft_count)
+        {
+            if (m_soft_level[m_soft_next] <= count)
+            {
+                out &= ~m_soft_off[m_soft_next];
+                m_soft_next++;
+                continue;
+            }
+            TIMER_CompareSet(LEDS_PWM_TIMER, LEDS_SOFT_CC, m_soft_level[m_soft_next]);
+            // The counter may have passed the new compare value meanwhile
+            count = TIMER_CounterGet(LEDS_PWM_TIMER);
+            if (m_soft_level[m_soft_next] > count)
+            {
+                break;
+            }
+        }
+    }
+
+    port_toggle(out ^ m_out);
+    m_out = out;
+}
+
+void leds_set (uint8_t pattern)
+{
+    leds_set_masked(LEDS_ALL, pattern);
+}
+
+void leds_set_masked (uint8_t mask, uint8_t pattern)
+{
+    int32_t lock = osKernelLock();
+    leds_set_masked_locked(mask, pattern);
+    osKernelRestoreLock(lock);
+}
+
+void leds_set_masked_locked (uint8_t mask, uint8_t pattern)
+{
+    m_state = (m_state & ~mask) | (pattern & mask);
+    apply();
+}
+
+void leds_toggle (uint8_t mask)
+{
+    int32_t lock = osKernelLock();
+    m_state ^= (mask & LEDS_ALL);
+    apply();
+    osKernelRestoreLock(lock);
+}
+
+uint8_t leds_get (void)
+{
+    return m_state;
+}
+
+void leds_brightness_set (uint8_t leds, uint8_t level)
+{
+    int32_t lock = osKernelLock();
+    leds_brightness_set_locked(leds, level);
+    osKernelRestoreLock(lock);
+}
+
+void leds_brightness_set_locked (uint8_t leds, uint8_t level)
+{
+    for (uint8_t i = 0; i < LEDS_COUNT; i++)
+    {
+        if (leds & (1 << i))
+        {
+            m_level[i] = level;
+        }
+    }
+    apply();
+}
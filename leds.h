@@ -0,0 +1,78 @@
+/**
+ * @brief Driver for the tsb0 LEDs, red PB11, green PB12 and blue PA5.
+ *
+ * LEDs are grouped by GPIO port and a pattern is applied with a single
+ * register write per port, so all LEDs on a port change in the same cycle.
+ * Each LED also has a brightness that applies while it is on.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef LEDS_H_
+#define LEDS_H_
+
+#include <stdint.h>
+
+#define LEDS_RED   (1 << 0)
+#define LEDS_GREEN (1 << 1)
+#define LEDS_BLUE  (1 << 2)
+#define LEDS_ALL   (LEDS_RED | LEDS_GREEN | LEDS_BLUE)
+#define LEDS_COUNT 3
+
+#define LEDS_LEVEL_MAX 255
+
+/**
+ * Set up the LED driver, all LEDs off.
+ * The pins must be configured as outputs with board_init().
+ */
+void leds_init (void);
+
+/**
+ * Apply a complete LED pattern.
+ *
+ * @param pattern LEDS_ bits of LEDs that should be on.
+ */
+void leds_set (uint8_t pattern);
+
+/**
+ * Change only the LEDs in mask.
+ *
+ * @param mask    LEDS_ bits of the LEDs to change.
+ * @param pattern LEDS_ bits of LEDs that should be on.
+ */
+void leds_set_masked (uint8_t mask, uint8_t pattern);
+
+/**
+ * leds_set_masked() for callers that already hold osKernelLock(), the
+ * kernel lock must not be nested.
+ */
+void leds_set_masked_locked (uint8_t mask, uint8_t pattern);
+
+/**
+ * Toggle the LEDs in mask.
+ *
+ * @param mask LEDS_ bits of the LEDs to toggle.
+ */
+void leds_toggle (uint8_t mask);
+
+/**
+ * @return LEDS_ bits of LEDs that are on.
+ */
+uint8_t leds_get (void);
+
+/**
+ * Set the brightness that LEDs have while they are on, the default
+ * is LEDS_LEVEL_MAX. Levels are linear PWM duty cycles, apply gamma
+ * correction for perceived brightness.
+ *
+ * @param leds  LEDS_ bits of the LEDs.
+ * @param level Brightness 0 to LEDS_LEVEL_MAX.
+ */
+void leds_brightness_set (uint8_t leds, uint8_t level);
+
+/**
+ * leds_brightness_set() for callers that already hold osKernelLock().
+ */
+void leds_brightness_set_locked (uint8_t leds, uint8_t level);
+
+#endif//LEDS_H_
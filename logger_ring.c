@@ -0,0 +1,111 @@
+/**
+ * @brief Lock-free multi-producer ring buffer log backend.
+ *
+ * Producers reserve a slot by advancing the head index with a
+ * compare-and-swap, copy the message and then publish the slot with its
+ * ready flag. The drain thread is the only consumer: it writes out ready
+ * slots in order, clears them and advances the tail. A slot that is
+ * reserved but not yet published holds back the slots after it, so the
+ * message order is always kept.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include "logger_ring.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <inttypes.h>
+
+#include "cmsis_os2.h"
+
+#if (LOGGER_RING_SLOTS & (LOGGER_RING_SLOTS - 1)) != 0
+#error "LOGGER_RING_SLOTS must be a power of 2"
+#endif
+
+#define LOGGER_RING_FLAG 0x00000001U
+
+typedef struct
+{
+    volatile uint8_t ready;
+    uint8_t len;
+    char data[LOGGER_RING_SLOT_SIZE];
+} logger_ring_slot_t;
+
+static logger_ring_slot_t m_slots[LOGGER_RING_SLOTS];
+static uint32_t m_head; // Next slot to reserve
+static uint32_t m_tail; // Next slot to drain
+static uint32_t m_dropped;
+
+static osThreadId_t m_drain_thread;
+
+static void logger_ring_drain (void *argument)
+{
+    uint32_t reported = 0;
+
+    for (;;)
+    {
+        osThreadFlagsWait(LOGGER_RING_FLAG, osFlagsWaitAny, osWaitForever);
+
+        for (;;)
+        {
+            uint32_t tail = __atomic_load_n(&m_tail, __ATOMIC_RELAXED);
+            logger_ring_slot_t * slot = &m_slots[tail & (LOGGER_RING_SLOTS - 1)];
+
+            if (!__atomic_load_n(&slot->ready, __ATOMIC_ACQUIRE))
+            {
+                break;
+            }
+            fwrite(slot->data, slot->len, 1, stdout);
+            __atomic_store_n(&slot->ready, 0, __ATOMIC_RELAXED);
+            __atomic_store_n(&m_tail, tail + 1, __ATOMIC_RELEASE);
+        }
+
+        uint32_t dropped = __atomic_load_n(&m_dropped, __ATOMIC_RELAXED);
+        if (dropped != reported)
+        {
+            printf("log dropped %"PRIu32"\r\n", dropped - reported);
+            reported = dropped;
+        }
+        fflush(stdout);
+    }
+}
+
+void logger_ring_init (const osThreadAttr_t * attr)
+{
+    m_drain_thread = osThreadNew(logger_ring_drain, NULL, attr);
+}
+
+int logger_ring (const char *ptr, int len)
+{
+    uint32_t head = __atomic_load_n(&m_head, __ATOMIC_RELAXED);
+
+    do
+    {
+        if (head - __atomic_load_n(&m_tail, __ATOMIC_ACQUIRE) >= LOGGER_RING_SLOTS)
+        {
+            __atomic_fetch_add(&m_dropped, 1, __ATOMIC_RELAXED);
+            return len;
+        }
+    }
+    while (!__atomic_compare_exchange_n(&m_head, &head, head + 1, true, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+
+    logger_ring_slot_t * slot = &m_slots[head & (LOGGER_RING_SLOTS - 1)];
+    slot->len = (len < LOGGER_RING_SLOT_SIZE) ? len : LOGGER_RING_SLOT_SIZE;
+    memcpy(slot->data, ptr, slot->len);
+    __atomic_store_n(&slot->ready, 1, __ATOMIC_RELEASE);
+
+    osThreadFlagsSet(m_drain_thread, LOGGER_RING_FLAG);
+    return len;
+}
+
+uint32_t logger_ring_dropped (void)
+{
+    return __atomic_load_n(&m_dropped, __ATOMIC_RELAXED);
+}
+
+uint32_t logger_ring_pending (void)
+{
+    return __atomic_load_n(&m_head, __ATOMIC_RELAXED) - __atomic_load_n(&m_tail, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,50 @@
+/**
+ * @brief Lock-free ring buffer log backend. Log calls only copy the
+ * message into the ring, a low priority thread drains the ring to stdout
+ * (RETARGET serial), so logging threads never wait for the UART.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef LOGGER_RING_H_
+#define LOGGER_RING_H_
+
+#include <stdint.h>
+
+#include "cmsis_os2.h"
+
+// Number of messages the ring holds, a power of 2
+#ifndef LOGGER_RING_SLOTS
+#define LOGGER_RING_SLOTS 16
+#endif//LOGGER_RING_SLOTS
+
+// Longer messages are truncated
+#ifndef LOGGER_RING_SLOT_SIZE
+#define LOGGER_RING_SLOT_SIZE 126
+#endif//LOGGER_RING_SLOT_SIZE
+
+/**
+ * Create the drain thread, call before log_init() with logger_ring.
+ * A low priority is recommended for the thread.
+ *
+ * @param attr Drain thread attributes, including its memory.
+ */
+void logger_ring_init (const osThreadAttr_t * attr);
+
+/**
+ * Log output function for log_init(), may be called from any thread or
+ * interrupt. Drops the message if the ring is full.
+ */
+int logger_ring (const char *ptr, int len);
+
+/**
+ * @return Number of messages dropped because the ring was full.
+ */
+uint32_t logger_ring_dropped (void);
+
+/**
+ * @return Number of messages waiting for the drain thread.
+ */
+uint32_t logger_ring_pending (void);
+
+#endif//LOGGER_RING_H_
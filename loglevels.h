@@ -2,5 +2,11 @@
 #define LOGLEVELS_H_
 
 #define LOG_LEVEL_main            LOG_LEVEL_DEBUG
+#define LOG_LEVEL_tone            LOG_LEVEL_DEBUG
+#define LOG_LEVEL_stackprof       LOG_LEVEL_DEBUG
+#define LOG_LEVEL_cpuload         LOG_LEVEL_DEBUG
+#define LOG_LEVEL_latency         LOG_LEVEL_DEBUG
+#define LOG_LEVEL_gpiobench       LOG_LEVEL_DEBUG
+#define LOG_LEVEL_gpiotrace       LOG_LEVEL_DEBUG
 
 #endif//LOGLEVELS_H_
@@ -29,9 +29,11 @@
 #include <stdint.h>
 #include <string.h>
 #include <inttypes.h>
+#include <stdbool.h>
 
 #include "retargetserial.h"
 #include "cmsis_os2.h"
+#include "FreeRTOS.h"
 #include "platform.h"
 
 #include "SignatureArea.h"
@@ -39,159 +41,424 @@
 
 #include "loggers_ext.h"
 #include "logger_fwrite.h"
+#ifdef LOGGER_RING
+#include "logger_ring.h"
+#endif//LOGGER_RING
+#include "binlog.h"
 
 #include "em_gpio.h"
 #include "em_cmu.h"
 
+#include "board.h"
+#include "leds.h"
+#include "ledpat.h"
+#include "tone.h"
+#include "melody.h"
+#include "gpioint.h"
+#include "button.h"
+#include "idle.h"
+#include "cycles.h"
+#include "stackprof.h"
+#include "imagecrc.h"
+#include "appheader.h"
+#include "bootphase.h"
+#include "cpuload.h"
+#include "latency.h"
+#include "gpiotrace.h"
+#ifdef GPIOBENCH
+#include "gpiobench.h"
+#endif//GPIOBENCH
+
 
 #include "loglevels.h"
 #define __MODUUL__ "main"
 #define __LOG_LEVEL__ (LOG_LEVEL_main & BASE_LOG_LEVEL)
 #include "log.h"
 
-// Include the information header binary
-#include "incbin.h"
-INCBIN(Header, "header.bin");
-
-void led_one();
-void buzzer_tone();
-
-// Heartbeat thread, initialize GPIO and print heartbeat messages.
-void hp_loop ()
+// Commands handled by the buzzer supervisor thread
+typedef enum
 {
-    #define ESWGPIO_HB_DELAY 10 // Heartbeat message delay, seconds
-    
-    // Initialize GPIO.
-    CMU_ClockEnable(cmuClock_GPIO, true);
-    GPIO_PinModeSet(gpioPortB, 12, gpioModePushPull, 0);
+    BUZZER_CMD_START, // Play the siren once
+    BUZZER_CMD_STOP,  // Stop the siren immediately
+    BUZZER_CMD_TONE,  // Change the frequencies (Hz) of the two siren tones
+    BUZZER_CMD_QUERY  // Log the current buzzer state and thread stack use
+} buzzer_cmd_type_t;
 
+typedef struct
+{
+    uint16_t type;       // buzzer_cmd_type_t
+    uint16_t tone_hz[2]; // Frequencies for BUZZER_CMD_TONE
+} buzzer_cmd_t;
+
+#define ESWGPIO_BUZZER_QUEUE_LEN 4
+
+// Thread stack sizes, bytes
+#define ESWGPIO_STACK_HP     1024 // Heartbeat, LED setup
+#define ESWGPIO_STACK_BUZZER 1024 // Button-buzzer supervisor
+#define ESWGPIO_STACK_LOG    1024 // Log ring drain, calls stdio
+#define ESWGPIO_STACK_GPIO   512  // Deferred GPIO interrupt callbacks
+
+// Set to 0 to create threads from the FreeRTOS heap for comparison
+#ifndef ESWGPIO_STATIC_ALLOC
+#define ESWGPIO_STATIC_ALLOC 1
+#endif//ESWGPIO_STATIC_ALLOC
+
+// osThreadNew() and the others return NULL for given memory without it
+#if configSUPPORT_STATIC_ALLOCATION != 1
+#error "configSUPPORT_STATIC_ALLOCATION must be 1, see FreeRTOSConfig.h"
+#endif//configSUPPORT_STATIC_ALLOCATION
+
+// Set to 1 to start the serial port and print the boot messages only once
+// the LEDs are running
+#ifndef ESWGPIO_DEFER_SERIAL
+#define ESWGPIO_DEFER_SERIAL 0
+#endif//ESWGPIO_DEFER_SERIAL
+#ifdef GPIOBENCH
+// The benchmark logs before the LEDs start
+#undef ESWGPIO_DEFER_SERIAL
+#define ESWGPIO_DEFER_SERIAL 0
+#endif//GPIOBENCH
+
+// Declare memory for a thread and build its attributes, the dynamic
+// build takes both from the FreeRTOS heap and declares nothing
+#if ESWGPIO_STATIC_ALLOC
+#define ESWGPIO_THREAD_MEM(id, stack_bytes) \
+    static uint64_t m_##id##_stack[(stack_bytes) / sizeof(uint64_t)]; \
+    static StaticTask_t m_##id##_cb
+#define ESWGPIO_THREAD_ATTR(id, thread_name, prio, stack_bytes) { .name = thread_name, \
+    .cb_mem = &m_##id##_cb, .cb_size = sizeof(m_##id##_cb), \
+    .stack_mem = m_##id##_stack, .stack_size = sizeof(m_##id##_stack), .priority = prio }
+#else
+#define ESWGPIO_THREAD_MEM(id, stack_bytes)
+#define ESWGPIO_THREAD_ATTR(id, thread_name, prio, stack_bytes) { .name = thread_name, \
+    .stack_size = (stack_bytes), .priority = prio }
+#endif//ESWGPIO_STATIC_ALLOC
+
+ESWGPIO_THREAD_MEM(hp, ESWGPIO_STACK_HP);
+ESWGPIO_THREAD_MEM(buzzer, ESWGPIO_STACK_BUZZER);
+ESWGPIO_THREAD_MEM(gpio, ESWGPIO_STACK_GPIO);
+#ifdef LOGGER_RING
+ESWGPIO_THREAD_MEM(log, ESWGPIO_STACK_LOG);
+#endif//LOGGER_RING
+
+static const osThreadAttr_t m_hp_attr = ESWGPIO_THREAD_ATTR(hp, "hp", osPriorityNormal, ESWGPIO_STACK_HP);
+static const osThreadAttr_t m_buzzer_attr = ESWGPIO_THREAD_ATTR(buzzer, "buzzer_tone", osPriorityNormal, ESWGPIO_STACK_BUZZER);
+static const osThreadAttr_t m_gpio_attr = ESWGPIO_THREAD_ATTR(gpio, "gpioint", osPriorityAboveNormal, ESWGPIO_STACK_GPIO);
+#ifdef LOGGER_RING
+static const osThreadAttr_t m_log_attr = ESWGPIO_THREAD_ATTR(log, "log", osPriorityLow, ESWGPIO_STACK_LOG);
+#endif//LOGGER_RING
+
+static osMessageQueueId_t m_buzzer_queue;
+static StaticQueue_t m_buzzer_queue_cb;
+
+// Thread creation cost, measured in main
+static uint32_t m_create_cycles;
+static size_t m_heap_used;
+
+// Siren, 2 different tones of 200ms each with 50ms breaks
+static uint16_t m_tone_hz[2] = { 500, 250 };
+static melody_step_t m_siren_steps[] = {
+    MELODY_STEP(500, 200, 50),
+    MELODY_STEP(250, 200, 50)
+};
+static const melody_t m_siren = { m_siren_steps, 2, false };
+
+// Application threads, for the memory map and the stack profiler
+static const osThreadAttr_t * const m_threads[] = {
+    &m_hp_attr, &m_buzzer_attr, &m_gpio_attr,
+#ifdef LOGGER_RING
+    &m_log_attr,
+#endif//LOGGER_RING
+};
+#define ESWGPIO_THREAD_COUNT (sizeof(m_threads) / sizeof(m_threads[0]))
+
+// Log the memory of the application threads
+static void ram_map (uint32_t create_cycles, size_t heap_used)
+{
+    uint32_t total = 0;
 
-// LED toggle thread.
-    const osThreadAttr_t LED1_thread_attr = { .name = "LED1" };
-    osThreadNew(led_one, NULL, &LED1_thread_attr);
-    
-    for (;;)
+    for (uint32_t i = 0; i < ESWGPIO_THREAD_COUNT; i++)
     {
-        osDelay(ESWGPIO_HB_DELAY*osKernelGetTickFreq());
-        info1("Heartbeat");
+        info1("%-12s stack %5"PRIu32" cb %3u", m_threads[i]->name, m_threads[i]->stack_size, (unsigned)sizeof(StaticTask_t));
+        total += m_threads[i]->stack_size + sizeof(StaticTask_t);
     }
+    info1("threads %"PRIu32" B, heap used %u B, created in %"PRIu32" cycles (%s)",
+          total, (unsigned)heap_used, create_cycles, ESWGPIO_STATIC_ALLOC ? "static" : "dynamic");
 }
 
-
-// This function enables LED toggles with 500ms intervals
-void led_one()
+int logger_fwrite_boot (const char *ptr, int len)
 {
-    for(;;)
-    {
-        osDelay(500);
-        GPIO_PinOutToggle(gpioPortB, 12);
-    }
+    fwrite(ptr, len, 1, stdout);
+    fflush(stdout);
+    return len;
 }
 
+// Configure log message output for the boot messages
+static void boot_serial (void)
+{
+    RETARGET_SerialInit();
+#ifdef LOGGER_BINLOG
+    binlog_init(&logger_fwrite_boot);
+    log_init(BASE_LOG_LEVEL, &logger_binlog, NULL);
+#else
+    log_init(BASE_LOG_LEVEL, &logger_fwrite_boot, NULL);
+#endif//LOGGER_BINLOG
+}
 
-// Makes 2 different tones of sound from buzzer
-// duration of each tone is 200ms with 50ms breaks
-void siren_sound()
+// Banner, image integrity and application header
+static void boot_info (void)
 {
-    // Lets the buzzer play in 1000ms/2=500Hz
-    // Durarion of that tone is 100*2ms=200ms
-    for(int i=0; i<100; i++)
+    binfo1("ESW-GPIO "VERSION_STR" (%d.%d.%d)", VERSION_MAJOR, VERSION_MINOR, VERSION_PATCH);
+
+    // Application header, parsed and cached once
+    const appheader_t * header = appheader_get();
+    if (header != NULL)
+    {
+        const appheader_version_t * version = appheader_version();
+        info1("header %s %s (%u.%u.%u) @%"PRIu32", size %"PRIu32" crc %04X", header->name, version->str,
+              version->major, version->minor, version->patch, header->timestamp, header->size, header->crc);
+    }
+    else
     {
-        osDelay(2);
-        GPIO_PinOutToggle(gpioPortA, 0);
+        warn1("header invalid");
     }
-    // Wait a little between 2 tones
-    // GPIO_PinOutToggle(gpioPortB, 11);
-    osDelay(50);
 
-    // Lets the buzzer play in 1000ms/4=250Hz
-    // Durarion of that tone is 50*4ms=200ms
-    for(int i=0; i<50; i++)
+    // The header holds the CRC, so it is left out of the computed one
+    bool crc_hw = imagecrc_init();
+    uint32_t crc_start = cycles_now();
+    uint16_t crc = imagecrc_compute_skip(imagecrc_image_start(), imagecrc_image_size(),
+                                         header, (header != NULL) ? header->header_size : 0);
+    info1("image %"PRIu32" B crc %04X in %"PRIu32" cycles (%s)", imagecrc_image_size(), crc,
+          cycles_now() - crc_start, crc_hw ? "gpcrc" : "sw");
+    if ((header != NULL) && (crc != header->crc))
     {
-        osDelay(4);
-        GPIO_PinOutToggle(gpioPortA, 0);
+        err1("image crc mismatch, header %04X", header->crc);
     }
-    // Wait a little between 2 tones
-    // GPIO_PinOutToggle(gpioPortB, 11);
-    osDelay(50);
 }
 
-
-// This function is responsible for waiting for button
-// to be pushed and call the siren_sound() function
-void buzzer_tone()
+// Heartbeat thread, initialize GPIO and print heartbeat messages
+// with the load report of the past interval.
+void hp_loop ()
 {
-    for(;;)
+    #define ESWGPIO_HB_DELAY 10 // Heartbeat message delay, seconds
+    
+    bootphase_mark(BOOTPHASE_SCHEDULER);
+
+    // Watch the stack use of all threads
+    stackprof_init(NULL, m_threads, ESWGPIO_THREAD_COUNT);
+
+    // Pins are configured by board_init()
+#ifdef GPIOBENCH
+    gpiobench_run();
+#endif//GPIOBENCH
+    leds_init();
+    ledpat_init();
+
+    // Green LED toggles with 500ms intervals
+    const ledpat_t led_blink = LEDPAT_BLINK(500, 500);
+    ledpat_start(LEDS_GREEN, &led_blink);
+    bootphase_mark(BOOTPHASE_FIRST_LED);
+
+#if ESWGPIO_DEFER_SERIAL
+    // Serial output and boot messages once the LEDs are running, the
+    // thread-safe logger is already in place
+    RETARGET_SerialInit();
+    bootphase_mark(BOOTPHASE_SERIAL);
+    boot_info();
+    bootphase_mark(BOOTPHASE_INFO);
+    ram_map(m_create_cycles, m_heap_used);
+#endif//ESWGPIO_DEFER_SERIAL
+    bootphase_report();
+
+#ifdef LOGGER_BINLOG
+    // Cost of a binary record against a formatted text message, both
+    // through the same thread-safe logger
+    uint32_t t0 = cycles_now();
+    binfo1("cost %u %u", 1u, 2u);
+    uint32_t t1 = cycles_now();
+    info1("cost %u %u", 1u, 2u);
+    uint32_t t2 = cycles_now();
+    info1("binlog %"PRIu32" text %"PRIu32" cycles per message", t1 - t0, t2 - t1);
+#endif//LOGGER_BINLOG
+
+    for (;;)
     {
-        if (GPIO_PinInGet(gpioPortF, 4) == 0)
-        {
-            siren_sound();
-        }
+        osDelay(ESWGPIO_HB_DELAY*osKernelGetTickFreq());
+        binfo1("Heartbeat");
+        cpuload_report();
+#if configUSE_TICKLESS_IDLE == 2
+        idle_stats_t em;
+        idle_stats(&em);
+        binfo1("EM0 %"PRIu32" EM1 %"PRIu32" EM2 %"PRIu32" ms", em.em0_ms, em.em1_ms, em.em2_ms);
+#endif//configUSE_TICKLESS_IDLE
     }
 }
 
-// Button-Buzzer interrupt thread.
 
-void buzzer_loop ()
+// Button events are turned into buzzer commands. A short press plays
+// the siren, a long press stops it and a double-click queries the state.
+static void button_event (button_event_t event)
 {
-    // Initialize GPIO.
-    CMU_ClockEnable(cmuClock_GPIO, true);
-    // Set Buzzer Pin as Output (GPIO A0)
-    GPIO_PinModeSet(gpioPortA, 0, gpioModePushPull, 0);
-    // Set LED 1 Pin as Output (GPIO B11) (USED FOR TEST PURPOSE)
-    GPIO_PinModeSet(gpioPortB, 11, gpioModePushPull, 0);
-    // Set Button Pin as Input (GPIO F4, InputPull mode)
-    GPIO_PinModeSet(gpioPortF, 4, gpioModeInputPull , 1);
-
-
-// Button-buzzer thread calls buzzer_tone method.
-    const osThreadAttr_t BUZZER_thread_attr = { .name = "BUZZER" };
-    osThreadNew(buzzer_tone, NULL, &BUZZER_thread_attr);
-    
-    for (;;)
+    buzzer_cmd_t cmd;
+
+    switch (event)
     {
+        case BUTTON_SHORT:
+            cmd.type = BUZZER_CMD_START;
+        break;
+        case BUTTON_LONG:
+            cmd.type = BUZZER_CMD_STOP;
+        break;
+        case BUTTON_DOUBLE:
+            cmd.type = BUZZER_CMD_QUERY;
+        break;
+        default:
+            return;
     }
+    osMessageQueuePut(m_buzzer_queue, &cmd, 0, 0);
 }
 
-int logger_fwrite_boot (const char *ptr, int len)
+// Button-Buzzer supervisor thread, sleeps on the command queue.
+void buzzer_loop ()
 {
-    fwrite(ptr, len, 1, stdout);
-    fflush(stdout);
-    return len;
+    tone_init();
+    melody_init();
+
+    static buzzer_cmd_t buzzer_queue_mem[ESWGPIO_BUZZER_QUEUE_LEN];
+    const osMessageQueueAttr_t buzzer_queue_attr = {
+        .name = "buzzer",
+        .cb_mem = &m_buzzer_queue_cb, .cb_size = sizeof(m_buzzer_queue_cb),
+        .mq_mem = buzzer_queue_mem, .mq_size = sizeof(buzzer_queue_mem)
+    };
+    m_buzzer_queue = osMessageQueueNew(ESWGPIO_BUZZER_QUEUE_LEN, sizeof(buzzer_cmd_t), &buzzer_queue_attr);
+
+    // Button (GPIO F4) events are debounced and classified
+    button_init(button_event);
+
+    for (;;)
+    {
+        buzzer_cmd_t cmd;
+
+        if (osOK != osMessageQueueGet(m_buzzer_queue, &cmd, NULL, osWaitForever))
+        {
+            continue;
+        }
+
+        switch (cmd.type)
+        {
+            case BUZZER_CMD_START:
+                // Presses that arrive while the siren is playing are dropped
+                if (!melody_active())
+                {
+                    melody_play(&m_siren);
+                }
+            break;
+            case BUZZER_CMD_STOP:
+                melody_stop();
+            break;
+            case BUZZER_CMD_TONE:
+            {
+                tone_note_t notes[2];
+                if (tone_note(cmd.tone_hz[0], &notes[0]) && tone_note(cmd.tone_hz[1], &notes[1]))
+                {
+                    // Do not change the steps under a playing siren
+                    melody_stop();
+                    m_siren_steps[0].note = notes[0];
+                    m_siren_steps[1].note = notes[1];
+                    m_tone_hz[0] = cmd.tone_hz[0];
+                    m_tone_hz[1] = cmd.tone_hz[1];
+                }
+                else
+                {
+                    warn1("tone %u/%u", cmd.tone_hz[0], cmd.tone_hz[1]);
+                }
+            }
+            break;
+            case BUZZER_CMD_QUERY:
+                info1("siren %s, tones %u/%u Hz", melody_active() ? "on" : "off",
+                      m_tone_hz[0], m_tone_hz[1]);
+                stackprof_dump();
+                latency_report();
+                gpiotrace_dump();
+            break;
+            default:
+                warn1("cmd %u", cmd.type);
+            break;
+        }
+    }
 }
 
 int main ()
 {
+    bootphase_mark(BOOTPHASE_MAIN);
     PLATFORM_Init();
+    board_init();
+    bootphase_mark(BOOTPHASE_PLATFORM);
 
-    // Configure log message output
-    RETARGET_SerialInit();
-    log_init(BASE_LOG_LEVEL, &logger_fwrite_boot, NULL);
-
-    info1("ESW-GPIO "VERSION_STR" (%d.%d.%d)", VERSION_MAJOR, VERSION_MINOR, VERSION_PATCH);
+#if !ESWGPIO_DEFER_SERIAL
+    boot_serial();
+    bootphase_mark(BOOTPHASE_SERIAL);
+    boot_info();
+    bootphase_mark(BOOTPHASE_INFO);
+#endif//ESWGPIO_DEFER_SERIAL
 
     // Initialize OS kernel.
     osKernelInitialize();
 
+#if configUSE_TICKLESS_IDLE == 2
+    // Wake-up source for sleeping between events
+    idle_init();
+#endif//configUSE_TICKLESS_IDLE
+    bootphase_mark(BOOTPHASE_KERNEL);
+
+    size_t heap_free = xPortGetFreeHeapSize();
+    uint32_t create_start = cycles_now();
+
     // Create a thread for heartbeat
-    const osThreadAttr_t hp_thread_attr = { .name = "hp" };
-    osThreadNew(hp_loop, NULL, &hp_thread_attr);
+    osThreadNew(hp_loop, NULL, &m_hp_attr);
 
     // Create a thread for button-buzzer
-    const osThreadAttr_t buzzer_thread_attr = { .name = "buzzer_tone" };
-    osThreadNew(buzzer_loop, NULL, &buzzer_thread_attr);
+    osThreadNew(buzzer_loop, NULL, &m_buzzer_attr);
+
+    // GPIO interrupt dispatcher and its thread for deferred callbacks
+    gpioint_init(&m_gpio_attr);
+
+#ifdef LOGGER_RING
+    // Create the log drain thread
+    logger_ring_init(&m_log_attr);
+#endif//LOGGER_RING
+
+    m_create_cycles = cycles_now() - create_start;
+    m_heap_used = heap_free - xPortGetFreeHeapSize();
+    bootphase_mark(BOOTPHASE_THREADS);
+#if !ESWGPIO_DEFER_SERIAL
+    ram_map(m_create_cycles, m_heap_used);
+#endif//ESWGPIO_DEFER_SERIAL
 
     if (osKernelReady == osKernelGetState())
     {
         // Switch to a thread-safe logger
+#ifdef LOGGER_RING
+        int (*logger)(const char *, int) = &logger_ring;
+#else
         logger_fwrite_init();
-        log_init(BASE_LOG_LEVEL, &logger_fwrite, NULL);
+        int (*logger)(const char *, int) = &logger_fwrite;
+#endif//LOGGER_RING
+#ifdef LOGGER_BINLOG
+        // Binary records go out through the thread-safe logger
+        binlog_init(logger);
+        logger = &logger_binlog;
+#endif//LOGGER_BINLOG
+        log_init(BASE_LOG_LEVEL, logger, NULL);
 
         // Start the kernel
         osKernelStart();
     }
     else
     {
+#if ESWGPIO_DEFER_SERIAL
+        boot_serial();
+#endif//ESWGPIO_DEFER_SERIAL
         err1("!osKernelReady");
     }
 
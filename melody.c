@@ -0,0 +1,141 @@
+/**
+ * @brief Tone sequencer on top of the tone engine.
+ *
+ * The sequencer state is changed by the API functions and by the timer
+ * callback running in the RTOS timer thread, the API functions lock the
+ * kernel to keep the callback from running in the middle of an update.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include "melody.h"
+
+#include "cmsis_os2.h"
+#include "FreeRTOS.h"
+
+static osTimerId_t m_step_timer;
+static StaticTimer_t m_step_timer_cb;
+
+static const melody_t * volatile m_current;
+static const melody_t * volatile m_next;
+static uint16_t m_index;
+static bool m_in_gap;
+
+static uint32_t ms_to_ticks (uint32_t ms)
+{
+    uint32_t ticks = ms * osKernelGetTickFreq() / 1000;
+    return ticks > 0 ? ticks : 1;
+}
+
+static void start_step (void)
+{
+    const melody_step_t * step = &m_current->steps[m_index];
+
+    m_in_gap = false;
+    tone_play_note(&step->note);
+    osTimerStart(m_step_timer, ms_to_ticks(step->duration_ms));
+}
+
+static void step_timeout (void *argument)
+{
+    int32_t lock = osKernelLock();
+
+    if (m_current != NULL)
+    {
+        const melody_step_t * step = &m_current->steps[m_index];
+
+        if ((!m_in_gap) && (step->gap_ms > 0))
+        {
+            tone_stop();
+            m_in_gap = true;
+            osTimerStart(m_step_timer, ms_to_ticks(step->gap_ms));
+        }
+        else
+        {
+            m_index++;
+            if (m_index >= m_current->count)
+            {
+                m_index = 0;
+                if (!m_current->loop)
+                {
+                    m_current = m_next;
+                    m_next = NULL;
+                }
+            }
+
+            if (m_current != NULL)
+            {
+                start_step();
+            }
+            else
+            {
+                tone_stop();
+            }
+        }
+    }
+
+    osKernelRestoreLock(lock);
+}
+
+void melody_init (void)
+{
+    const osTimerAttr_t timer_attr = { .name = "melody", .cb_mem = &m_step_timer_cb, .cb_size = sizeof(m_step_timer_cb) };
+    m_step_timer = osTimerNew(step_timeout, osTimerOnce, NULL, &timer_attr);
+}
+
+bool melody_play (const melody_t * melody)
+{
+    if ((melody == NULL) || (melody->count == 0))
+    {
+        return false;
+    }
+
+    int32_t lock = osKernelLock();
+    m_current = melody;
+    m_next = NULL;
+    m_index = 0;
+    start_step();
+    osKernelRestoreLock(lock);
+    return true;
+}
+
+bool melody_queue (const melody_t * melody)
+{
+    bool queued = false;
+
+    if ((melody == NULL) || (melody->count == 0))
+    {
+        return false;
+    }
+
+    int32_t lock = osKernelLock();
+    if (m_current == NULL)
+    {
+        m_current = melody;
+        m_index = 0;
+        start_step();
+        queued = true;
+    }
+    else if (m_next == NULL)
+    {
+        m_next = melody;
+        queued = true;
+    }
+    osKernelRestoreLock(lock);
+    return queued;
+}
+
+void melody_stop (void)
+{
+    int32_t lock = osKernelLock();
+    osTimerStop(m_step_timer);
+    m_current = NULL;
+    m_next = NULL;
+    tone_stop();
+    osKernelRestoreLock(lock);
+}
+
+bool melody_active (void)
+{
+    return m_current != NULL;
+}
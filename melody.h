@@ -0,0 +1,70 @@
+/**
+ * @brief Tone sequencer, plays melodies described as arrays of steps on the
+ * tone engine. Steps are advanced from an RTOS timer callback, so playing a
+ * melody does not need a thread of its own.
+ *
+ * Step notes are converted into timer reload values at compile time with
+ * MELODY_STEP(), nothing is divided while a melody is playing.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef MELODY_H_
+#define MELODY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "tone.h"
+
+typedef struct
+{
+    tone_note_t note;     // Tone to play, TONE_REST for silence
+    uint16_t duration_ms; // Tone duration
+    uint16_t gap_ms;      // Silence after the tone
+} melody_step_t;
+
+typedef struct
+{
+    const melody_step_t * steps;
+    uint16_t count;
+    bool loop; // Restart from the first step until stopped
+} melody_t;
+
+#define MELODY_STEP(freq_hz, duration_ms, gap_ms) { TONE_NOTE(freq_hz), (duration_ms), (gap_ms) }
+#define MELODY_PAUSE(duration_ms)                  { TONE_REST, (duration_ms), 0 }
+
+/**
+ * Initialize the sequencer, tone_init() must have been called.
+ */
+void melody_init (void);
+
+/**
+ * Start playing a melody, replaces the current and the queued melody.
+ *
+ * @param melody Melody to play, must remain valid while playing.
+ * @return true if started.
+ */
+bool melody_play (const melody_t * melody);
+
+/**
+ * Queue a melody to start right after the current one ends, without a gap.
+ * Starts immediately if nothing is playing. A looping melody must be stopped
+ * or replaced, it does not end on its own.
+ *
+ * @param melody Melody to play, must remain valid while playing.
+ * @return true if queued, false if another melody is already queued.
+ */
+bool melody_queue (const melody_t * melody);
+
+/**
+ * Stop the current melody and drop the queued one.
+ */
+void melody_stop (void);
+
+/**
+ * @return true while a melody is playing.
+ */
+bool melody_active (void);
+
+#endif//MELODY_H_
@@ -0,0 +1,68 @@
+/**
+ * @brief Board pins as compile-time port, pin pairs and inline accessors.
+ *
+ * A pin name expands to two arguments, so it can be passed to emlib calls
+ * as well as to the accessors below, for example pin_set(PIN_LED_GREEN).
+ * With constant arguments the accessors compile to one store to a fixed
+ * address. Series 1 GPIO has no DOUTSET/DOUTCLR registers, set and clear
+ * go through the peripheral BITSET/BITCLR aliases of DOUT and toggle
+ * through DOUTTGL.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef PINS_H_
+#define PINS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "em_bus.h"
+#include "em_gpio.h"
+
+#define PIN_LED_RED   gpioPortB, 11
+#define PIN_LED_GREEN gpioPortB, 12
+#define PIN_LED_BLUE  gpioPortA, 5
+#define PIN_BUTTON    gpioPortF, 4
+#define PIN_BUZZER    gpioPortA, 0
+
+#define PIN_PORT_(port, pin) (port)
+#define PIN_NUM_(port, pin)  (pin)
+#define PIN_PORT(p) PIN_PORT_(p)
+#define PIN_NUM(p)  PIN_NUM_(p)
+
+#define PIN_INLINE static inline __attribute__((always_inline))
+
+PIN_INLINE void pin_set (GPIO_Port_TypeDef port, uint8_t pin)
+{
+    BUS_RegMaskedSet(&GPIO->P[port].DOUT, 1UL << pin);
+}
+
+PIN_INLINE void pin_clear (GPIO_Port_TypeDef port, uint8_t pin)
+{
+    BUS_RegMaskedClear(&GPIO->P[port].DOUT, 1UL << pin);
+}
+
+PIN_INLINE void pin_toggle (GPIO_Port_TypeDef port, uint8_t pin)
+{
+    GPIO->P[port].DOUTTGL = 1UL << pin;
+}
+
+PIN_INLINE void pin_write (GPIO_Port_TypeDef port, uint8_t pin, bool high)
+{
+    if (high)
+    {
+        pin_set(port, pin);
+    }
+    else
+    {
+        pin_clear(port, pin);
+    }
+}
+
+PIN_INLINE bool pin_get (GPIO_Port_TypeDef port, uint8_t pin)
+{
+    return (GPIO->P[port].DIN >> pin) & 1;
+}
+
+#endif//PINS_H_
@@ -0,0 +1,153 @@
+/**
+ * @brief Stack high-water-mark profiler on a periodic RTOS timer.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include "stackprof.h"
+
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "FreeRTOS.h"
+
+#include "loglevels.h"
+#define __MODUUL__ "stack"
+#define __LOG_LEVEL__ (LOG_LEVEL_stackprof & BASE_LOG_LEVEL)
+#include "log.h"
+
+typedef struct
+{
+    osThreadId_t thread;
+    uint32_t min_free;
+    bool alarmed;
+} stackprof_entry_t;
+
+// Entries are changed with the kernel locked, the sampler runs in the
+// timer thread and must not wait for a thread that is logging
+static stackprof_entry_t m_entries[STACKPROF_MAX_THREADS];
+static uint32_t m_count;
+static stackprof_alarm_f m_alarm;
+static const osThreadAttr_t * const * m_threads;
+static uint32_t m_thread_count;
+
+static osTimerId_t m_timer;
+static StaticTimer_t m_timer_cb;
+
+static stackprof_entry_t * find (osThreadId_t thread)
+{
+    for (uint32_t i = 0; i < m_count; i++)
+    {
+        if (m_entries[i].thread == thread)
+        {
+            return &m_entries[i];
+        }
+    }
+    if (m_count < STACKPROF_MAX_THREADS)
+    {
+        stackprof_entry_t * entry = &m_entries[m_count++];
+        entry->thread = thread;
+        entry->min_free = UINT32_MAX;
+        entry->alarmed = false;
+        return entry;
+    }
+    return NULL;
+}
+
+void stackprof_sample (void)
+{
+    osThreadId_t threads[STACKPROF_MAX_THREADS];
+    stackprof_entry_t alarms[STACKPROF_MAX_THREADS];
+    uint32_t alarm_count = 0;
+
+    int32_t lock = osKernelLock();
+
+    uint32_t count = osThreadEnumerate(threads, STACKPROF_MAX_THREADS);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        stackprof_entry_t * entry = find(threads[i]);
+        if (entry == NULL)
+        {
+            continue;
+        }
+
+        uint32_t free = osThreadGetStackSpace(threads[i]);
+        if (free < entry->min_free)
+        {
+            entry->min_free = free;
+        }
+
+        if ((entry->min_free < STACKPROF_ALARM_BYTES) && (!entry->alarmed))
+        {
+            entry->alarmed = true;
+            alarms[alarm_count++] = *entry;
+        }
+    }
+
+    osKernelRestoreLock(lock);
+
+    for (uint32_t i = 0; i < alarm_count; i++)
+    {
+        warn1("%s free %"PRIu32, osThreadGetName(alarms[i].thread), alarms[i].min_free);
+        if (m_alarm != NULL)
+        {
+            m_alarm(alarms[i].thread, alarms[i].min_free);
+        }
+    }
+}
+
+// Stack size from the thread attributes, 0 if the thread is not listed
+static uint32_t stack_size (const char * name)
+{
+    for (uint32_t i = 0; (name != NULL) && (i < m_thread_count); i++)
+    {
+        if ((m_threads[i]->name != NULL) && (strcmp(m_threads[i]->name, name) == 0))
+        {
+            return m_threads[i]->stack_size;
+        }
+    }
+    return 0;
+}
+
+static void stackprof_timeout (void *argument)
+{
+    stackprof_sample();
+}
+
+void stackprof_init (stackprof_alarm_f alarm, const osThreadAttr_t * const threads[], uint32_t count)
+{
+    m_alarm = alarm;
+    m_threads = threads;
+    m_thread_count = count;
+
+    const osTimerAttr_t timer_attr = { .name = "stack", .cb_mem = &m_timer_cb, .cb_size = sizeof(m_timer_cb) };
+    m_timer = osTimerNew(stackprof_timeout, osTimerPeriodic, NULL, &timer_attr);
+    osTimerStart(m_timer, STACKPROF_PERIOD_MS * osKernelGetTickFreq() / 1000);
+}
+
+void stackprof_dump (void)
+{
+    stackprof_entry_t entries[STACKPROF_MAX_THREADS];
+
+    stackprof_sample();
+
+    // Log from a copy, logging may block on the UART
+    int32_t lock = osKernelLock();
+    uint32_t count = m_count;
+    memcpy(entries, m_entries, count * sizeof(stackprof_entry_t));
+    osKernelRestoreLock(lock);
+
+    info1("%-12s %5s %5s %4s", "thread", "size", "free", "use%");
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const char * name = osThreadGetName(entries[i].thread);
+        uint32_t size = stack_size(name);
+        uint32_t used = (size > entries[i].min_free) ? size - entries[i].min_free : 0;
+
+        info1("%-12s %5"PRIu32" %5"PRIu32" %4"PRIu32"%s",
+              name != NULL ? name : "?", size, entries[i].min_free,
+              (size > 0) ? (used * 100 / size) : 0,
+              entries[i].alarmed ? " !" : "");
+    }
+}
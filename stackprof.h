@@ -0,0 +1,61 @@
+/**
+ * @brief Stack high-water-mark profiler. The free stack space of every
+ * thread is sampled on a period, the minimum is kept per thread and an
+ * alarm is raised once for a thread when its headroom drops below a
+ * threshold.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef STACKPROF_H_
+#define STACKPROF_H_
+
+#include <stdint.h>
+
+#include "cmsis_os2.h"
+
+// Sampling period
+#ifndef STACKPROF_PERIOD_MS
+#define STACKPROF_PERIOD_MS 1000
+#endif//STACKPROF_PERIOD_MS
+
+// Alarm when a thread has less free stack than this, bytes
+#ifndef STACKPROF_ALARM_BYTES
+#define STACKPROF_ALARM_BYTES 128
+#endif//STACKPROF_ALARM_BYTES
+
+// Number of threads that can be tracked
+#ifndef STACKPROF_MAX_THREADS
+#define STACKPROF_MAX_THREADS 12
+#endif//STACKPROF_MAX_THREADS
+
+/**
+ * Stack alarm callback, called from the RTOS timer thread.
+ *
+ * @param thread   Thread that is low on stack.
+ * @param free     Minimum free stack seen, bytes.
+ */
+typedef void (*stackprof_alarm_f)(osThreadId_t thread, uint32_t free);
+
+/**
+ * Start sampling. The RTOS cannot report stack sizes, so they are taken
+ * from the attributes the threads were created with, matched by name.
+ *
+ * @param alarm   Alarm callback, NULL to only log a warning.
+ * @param threads Attributes of the application threads, must stay valid.
+ * @param count   Number of attributes.
+ */
+void stackprof_init (stackprof_alarm_f alarm, const osThreadAttr_t * const threads[], uint32_t count);
+
+/**
+ * Take a sample of all threads now.
+ */
+void stackprof_sample (void);
+
+/**
+ * Log the stack size, minimum free space and peak use of all threads,
+ * size and use are shown only for threads given to stackprof_init().
+ */
+void stackprof_dump (void);
+
+#endif//STACKPROF_H_
@@ -0,0 +1,161 @@
+/**
+ * @brief Buzzer tone engine on TIMER0 CC0 PWM output.
+ *
+ * The timer runs from the HFPER clock. For every tone the smallest prescaler
+ * that fits the period into the 16-bit TOP register is used, the compare
+ * value is set to half of the period for a 50% duty cycle. While stopped the
+ * CC0 route is disabled and the pin falls back to its GPIO output level.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include "tone.h"
+
+#include <inttypes.h>
+
+#include "cmsis_os2.h"
+#include "FreeRTOS.h"
+
+#include "em_bus.h"
+#include "em_cmu.h"
+#include "em_timer.h"
+
+#include "idle.h"
+#include "latency.h"
+#include "gpiotrace.h"
+
+#include "loglevels.h"
+#define __MODUUL__ "tone"
+#define __LOG_LEVEL__ (LOG_LEVEL_tone & BASE_LOG_LEVEL)
+#include "log.h"
+
+#define TONE_TIMER       TIMER0
+#define TONE_TIMER_CLOCK cmuClock_TIMER0
+#define TONE_CC          0
+#define TONE_ROUTELOC    TIMER_ROUTELOC0_CC0LOC_LOC0 // PA0
+#define TONE_ROUTEPEN    TIMER_ROUTEPEN_CC0PEN
+
+static uint32_t m_timer_freq;
+static osTimerId_t m_duration_timer;
+static StaticTimer_t m_duration_timer_cb;
+static bool m_active;
+
+static void tone_timeout (void *argument)
+{
+    tone_stop();
+}
+
+void tone_init (void)
+{
+    CMU_ClockEnable(TONE_TIMER_CLOCK, true);
+    m_timer_freq = CMU_ClockFreqGet(TONE_TIMER_CLOCK);
+    if (m_timer_freq != TONE_TIMER_HZ)
+    {
+        warn1("clk %"PRIu32"!=%"PRIu32, m_timer_freq, (uint32_t)TONE_TIMER_HZ);
+    }
+
+    TIMER_InitCC_TypeDef cc_init = TIMER_INITCC_DEFAULT;
+    cc_init.mode = timerCCModePWM;
+    TIMER_InitCC(TONE_TIMER, TONE_CC, &cc_init);
+
+    TIMER_Init_TypeDef timer_init = TIMER_INIT_DEFAULT;
+    timer_init.enable = false;
+    TIMER_Init(TONE_TIMER, &timer_init);
+
+    TONE_TIMER->ROUTELOC0 = TONE_ROUTELOC;
+    TONE_TIMER->ROUTEPEN = 0;
+
+    const osTimerAttr_t timer_attr = { .name = "tone", .cb_mem = &m_duration_timer_cb, .cb_size = sizeof(m_duration_timer_cb) };
+    m_duration_timer = osTimerNew(tone_timeout, osTimerOnce, NULL, &timer_attr);
+}
+
+bool tone_note (uint32_t freq_hz, tone_note_t *note)
+{
+    if ((freq_hz == 0) || (freq_hz > m_timer_freq / 2))
+    {
+        return false;
+    }
+
+    // Find the smallest prescaler that fits the period into TOP
+    uint32_t presc = 0;
+    uint32_t period = m_timer_freq / freq_hz;
+    while (period > TONE_PERIOD_MAX)
+    {
+        if (presc == TONE_PRESC_MAX)
+        {
+            return false;
+        }
+        presc++;
+        period = (m_timer_freq >> presc) / freq_hz;
+    }
+
+    note->presc = presc;
+    note->top = period - 1;
+    return true;
+}
+
+void tone_play_note (const tone_note_t *note)
+{
+    if (note->top == 0)
+    {
+        tone_stop();
+        return;
+    }
+
+    TIMER_Enable(TONE_TIMER, false);
+    BUS_RegMaskedWrite(&TONE_TIMER->CTRL, _TIMER_CTRL_PRESC_MASK, (uint32_t)note->presc << _TIMER_CTRL_PRESC_SHIFT);
+    TIMER_TopSet(TONE_TIMER, note->top);
+    TIMER_CompareSet(TONE_TIMER, TONE_CC, ((uint32_t)note->top + 1) >> 1); // 50% duty
+    TIMER_CounterSet(TONE_TIMER, 0);
+    TONE_TIMER->ROUTEPEN = TONE_ROUTEPEN;
+    TIMER_Enable(TONE_TIMER, true);
+    gpiotrace_tone(note->presc, note->top);
+
+    // The timer stops in EM2
+    if (!__atomic_exchange_n(&m_active, true, __ATOMIC_RELAXED))
+    {
+        latency_stop(LATENCY_BUTTON_TONE);
+        idle_em2_block();
+    }
+}
+
+bool tone_play (uint32_t freq_hz, uint32_t duration_ms)
+{
+    tone_note_t note;
+
+    if (!tone_note(freq_hz, &note))
+    {
+        warn1("freq %"PRIu32, freq_hz);
+        return false;
+    }
+
+    tone_play_note(&note);
+
+    if (duration_ms > 0)
+    {
+        osTimerStart(m_duration_timer, duration_ms * osKernelGetTickFreq() / 1000);
+    }
+    else
+    {
+        osTimerStop(m_duration_timer);
+    }
+    return true;
+}
+
+void tone_stop (void)
+{
+    osTimerStop(m_duration_timer);
+    TONE_TIMER->ROUTEPEN = 0;
+    TIMER_Enable(TONE_TIMER, false);
+    gpiotrace_tone(0, 0);
+
+    if (__atomic_exchange_n(&m_active, false, __ATOMIC_RELAXED))
+    {
+        idle_em2_unblock();
+    }
+}
+
+bool tone_active (void)
+{
+    return __atomic_load_n(&m_active, __ATOMIC_RELAXED);
+}
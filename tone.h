@@ -0,0 +1,106 @@
+/**
+ * @brief Buzzer tone engine. Tones are generated by TIMER0 in PWM mode with
+ * the CC0 output routed to the buzzer pin PA0, so the CPU does no work per
+ * half-period. Only starting and stopping a tone takes CPU time.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#ifndef TONE_H_
+#define TONE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Tone timer input clock, the tsb0 HFPER clock runs from the 38.4MHz HFXO.
+// Used for notes computed at compile time, tone_init() warns on mismatch.
+#ifndef TONE_TIMER_HZ
+#define TONE_TIMER_HZ 38400000UL
+#endif//TONE_TIMER_HZ
+
+#define TONE_PERIOD_MAX 65536UL // 16-bit TOP register
+#define TONE_PRESC_MAX  10      // Divide by 1024
+
+/**
+ * A tone as timer reload values, a zero top is silence.
+ */
+typedef struct
+{
+    uint8_t presc;  // Prescaler as power of 2
+    uint16_t top;   // Timer TOP value, period - 1
+} tone_note_t;
+
+// Compile-time conversion of a frequency into timer reload values, the
+// smallest prescaler that fits the period into TOP is chosen.
+#define TONE_FITS(freq_hz, presc) (((TONE_TIMER_HZ >> (presc)) / (freq_hz)) <= TONE_PERIOD_MAX)
+#define TONE_PRESC(freq_hz) ( \
+    TONE_FITS(freq_hz, 0) ? 0 : TONE_FITS(freq_hz, 1) ? 1 : TONE_FITS(freq_hz, 2) ? 2 : \
+    TONE_FITS(freq_hz, 3) ? 3 : TONE_FITS(freq_hz, 4) ? 4 : TONE_FITS(freq_hz, 5) ? 5 : \
+    TONE_FITS(freq_hz, 6) ? 6 : TONE_FITS(freq_hz, 7) ? 7 : TONE_FITS(freq_hz, 8) ? 8 : \
+    TONE_FITS(freq_hz, 9) ? 9 : TONE_PRESC_MAX)
+#define TONE_TOP(freq_hz) (((TONE_TIMER_HZ >> TONE_PRESC(freq_hz)) / (freq_hz)) - 1)
+
+#define TONE_NOTE(freq_hz) { .presc = TONE_PRESC(freq_hz), .top = TONE_TOP(freq_hz) }
+#define TONE_REST          { .presc = 0, .top = 0 }
+
+// Note frequencies, Hz
+#define NOTE_C4  262
+#define NOTE_D4  294
+#define NOTE_E4  330
+#define NOTE_F4  349
+#define NOTE_G4  392
+#define NOTE_A4  440
+#define NOTE_B4  494
+#define NOTE_C5  523
+#define NOTE_D5  587
+#define NOTE_E5  659
+#define NOTE_F5  698
+#define NOTE_G5  784
+#define NOTE_A5  880
+#define NOTE_B5  988
+#define NOTE_C6 1047
+
+/**
+ * Initialize the tone timer and route its output to the buzzer pin.
+ * The buzzer pin must already be configured as a push-pull output.
+ */
+void tone_init (void);
+
+/**
+ * Convert a frequency into timer reload values at runtime, prefer
+ * TONE_NOTE() for frequencies known at compile time.
+ *
+ * @param freq_hz Tone frequency in Hz.
+ * @param note    Resulting note.
+ * @return true if the frequency can be generated.
+ */
+bool tone_note (uint32_t freq_hz, tone_note_t *note);
+
+/**
+ * Start playing a note until tone_stop() or the next note, a rest stops
+ * the tone. Does no divisions, suitable for the melody sequencer.
+ *
+ * @param note Precomputed note.
+ */
+void tone_play_note (const tone_note_t *note);
+
+/**
+ * Start playing a tone, a tone that is already playing is replaced.
+ *
+ * @param freq_hz     Tone frequency in Hz.
+ * @param duration_ms Tone length in milliseconds, 0 plays until tone_stop().
+ * @return true if the frequency can be generated and the tone was started.
+ */
+bool tone_play (uint32_t freq_hz, uint32_t duration_ms);
+
+/**
+ * Stop the tone and leave the buzzer pin low.
+ */
+void tone_stop (void);
+
+/**
+ * @return true while a tone is being played.
+ */
+bool tone_active (void);
+
+#endif//TONE_H_
@@ -0,0 +1,403 @@
+/**
+ * @brief Host tool that validates and compares application header files
+ * with the parser of the firmware, built by make host.
+ *
+ *   appheader_check header.bin               print the fields
+ *   appheader_check a.bin b.bin              print the fields that differ
+ *   appheader_check -e name=esw-gpio ... header.bin
+ *                                            also compare fields with the
+ *                                            values given to HEADEREDIT
+ *   appheader_check -i image.bin header.bin  find the header in a stamped
+ *                                            image, check its size and CRC
+ *
+ * Field names are the HEADEREDIT ones. Numbers are given in C notation,
+ * versionbin and the UUIDs in hex, dashes are ignored. The firmware build
+ * runs it on header.bin with the Makefile values, which checks the
+ * appheader_t layout against the file HEADEREDIT actually wrote.
+ *
+ * With -i the header is looked up in the image by its bytes, except for
+ * the size and CRC that HEADEREDIT stamps again into the image. The CRC
+ * of the image is computed with imagecrc.c over the ranges HEADEREDIT
+ * could have covered, the ones that give the stamped CRC are printed.
+ * The image passes if the range that the boot check in main.c uses is
+ * one of them, the image without the embedded header.
+ *
+ * Exits with 0 when the header is valid and nothing differs.
+ *
+ * Copyright ProLab TTÜ 2022
+ * @license MIT
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <ctype.h>
+#include <inttypes.h>
+
+#include "appheader.h"
+#include "imagecrc.h"
+
+#define APPHEADER_CHECK_MAX_EXPECT 16
+#define APPHEADER_CHECK_FILE_MAX   (1024 * 1024)
+
+typedef enum
+{
+    FIELD_UINT,
+    FIELD_STR,
+    FIELD_HEX
+} field_type_t;
+
+typedef struct
+{
+    const char * name;
+    uint16_t offset;
+    uint8_t size;
+    field_type_t type;
+} field_t;
+
+#define FIELD(name, member, type) { name, offsetof(appheader_t, member), sizeof(((appheader_t *)0)->member), type }
+
+static const field_t m_fields[] = {
+    FIELD("header_version", header_version, FIELD_UINT),
+    FIELD("softtype", softtype, FIELD_UINT),
+    FIELD("header_size", header_size, FIELD_UINT),
+    FIELD("firmaddr", firmaddr, FIELD_UINT),
+    FIELD("firmsizemax", firmsizemax, FIELD_UINT),
+    FIELD("size", size, FIELD_UINT),
+    FIELD("crc", crc, FIELD_UINT),
+    FIELD("versionbin", versionbin, FIELD_HEX),
+    FIELD("version", version, FIELD_STR),
+    FIELD("uuid", uuid_board, FIELD_HEX),
+    FIELD("uuid2", uuid_platform, FIELD_HEX),
+    FIELD("uuid3", uuid_application, FIELD_HEX),
+    FIELD("timestamp", timestamp, FIELD_UINT),
+    FIELD("name", name, FIELD_STR),
+};
+
+#define FIELD_COUNT (sizeof(m_fields) / sizeof(m_fields[0]))
+
+// Little endian like the target
+static uint32_t field_uint (const uint8_t * h, const field_t * f)
+{
+    uint32_t value = 0;
+
+    for (uint8_t i = f->size; i > 0; i--)
+    {
+        value = (value << 8) | h[f->offset + i - 1];
+    }
+    return value;
+}
+
+static void field_print (FILE * out, const uint8_t * h, const field_t * f)
+{
+    switch (f->type)
+    {
+        case FIELD_UINT:
+            fprintf(out, "%"PRIu32, field_uint(h, f));
+        break;
+        case FIELD_STR:
+            fprintf(out, "%.*s", f->size, (const char *)&h[f->offset]);
+        break;
+        case FIELD_HEX:
+            for (uint8_t i = 0; i < f->size; i++)
+            {
+                fprintf(out, "%02X", h[f->offset + i]);
+            }
+        break;
+    }
+}
+
+// Hex digits into bytes, the rest of the field must be zero
+static bool hex_equal (const uint8_t * data, uint8_t size, const char * hex)
+{
+    uint8_t i = 0;
+
+    while (*hex != '\0')
+    {
+        if (*hex == '-')
+        {
+            hex++;
+            continue;
+        }
+        if (!isxdigit((unsigned char)hex[0]) || !isxdigit((unsigned char)hex[1]) || (i >= size))
+        {
+            return false;
+        }
+        char byte[3] = { hex[0], hex[1], '\0' };
+        if (data[i++] != (uint8_t)strtoul(byte, NULL, 16))
+        {
+            return false;
+        }
+        hex += 2;
+    }
+    for (; i < size; i++)
+    {
+        if (data[i] != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool field_equal (const uint8_t * h, const field_t * f, const char * value)
+{
+    switch (f->type)
+    {
+        case FIELD_UINT:
+        {
+            char * end;
+            unsigned long expected = strtoul(value, &end, 0);
+            return (*value != '\0') && (*end == '\0') && (expected == field_uint(h, f));
+        }
+        case FIELD_STR:
+            return (strlen(value) < f->size) && (strcmp((const char *)&h[f->offset], value) == 0);
+        case FIELD_HEX:
+            return hex_equal(&h[f->offset], f->size, value);
+    }
+    return false;
+}
+
+static const field_t * field_find (const char * name, size_t len)
+{
+    for (uint32_t i = 0; i < FIELD_COUNT; i++)
+    {
+        if ((strlen(m_fields[i].name) == len) && (strncmp(m_fields[i].name, name, len) == 0))
+        {
+            return &m_fields[i];
+        }
+    }
+    return NULL;
+}
+
+static uint8_t * load (const char * path, uint32_t * len)
+{
+    FILE * f = fopen(path, "rb");
+    uint8_t * data = malloc(APPHEADER_CHECK_FILE_MAX);
+
+    *len = 0;
+    if ((f == NULL) || (data == NULL))
+    {
+        fprintf(stderr, "%s: cannot read\n", path);
+        if (f != NULL)
+        {
+            fclose(f);
+        }
+        free(data);
+        return NULL;
+    }
+    *len = (uint32_t)fread(data, 1, APPHEADER_CHECK_FILE_MAX, f);
+    fclose(f);
+    return data;
+}
+
+// Parsed header of a file, the whole file must be the header
+static const appheader_t * load_header (const char * path, uint8_t ** data)
+{
+    uint32_t len;
+
+    *data = load(path, &len);
+    if (*data == NULL)
+    {
+        return NULL;
+    }
+    const appheader_t * h = appheader_parse(*data, len);
+    if (h == NULL)
+    {
+        fprintf(stderr, "%s: not a valid header, %"PRIu32" bytes, appheader_t is %u\n",
+                path, len, (unsigned)sizeof(appheader_t));
+    }
+    return h;
+}
+
+// Same bytes except for the fields stamped again into the image
+static bool header_at (const uint8_t * image, const uint8_t * header, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++)
+    {
+        if (((i >= offsetof(appheader_t, size)) && (i < offsetof(appheader_t, crc) + sizeof(uint16_t)))
+         || (image[i] == header[i]))
+        {
+            continue;
+        }
+        return false;
+    }
+    return true;
+}
+
+static int check_image (const char * path, const appheader_t * header)
+{
+    uint32_t len;
+    uint8_t * image = load(path, &len);
+    uint32_t hlen = header->header_size;
+    uint32_t at = 0;
+    uint32_t found = 0;
+    int result = 0;
+
+    if (image == NULL)
+    {
+        return 1;
+    }
+    for (uint32_t i = 0; i + hlen <= len; i++)
+    {
+        if (header_at(&image[i], (const uint8_t *)header, hlen))
+        {
+            at = (found == 0) ? i : at;
+            found++;
+        }
+    }
+    if (found != 1)
+    {
+        fprintf(stderr, "%s: header found %"PRIu32" times\n", path, found);
+        free(image);
+        return 1;
+    }
+
+    const appheader_t * h = (const appheader_t *)&image[at];
+    printf("header at      0x%"PRIX32"\n", at);
+    printf("size           %"PRIu32"%s\n", h->size, (h->size == len) ? "" : " != image size");
+    if (h->size != len)
+    {
+        fprintf(stderr, "%s: size %"PRIu32", image is %"PRIu32" bytes\n", path, h->size, len);
+        result = 1;
+    }
+
+    uint32_t crc_at = at + offsetof(appheader_t, crc);
+    uint16_t crc_field = h->crc;
+    struct
+    {
+        const char * name;
+        uint16_t crc;
+    } ranges[] = {
+        { "image without header", imagecrc_compute_skip(image, len, &image[at], hlen) },
+        { "image without crc field", imagecrc_compute_skip(image, len, &image[crc_at], sizeof(uint16_t)) },
+        { "image with zero crc field", 0 },
+        { "image after header", imagecrc_compute(&image[at + hlen], len - at - hlen) },
+        { "image before header", imagecrc_compute(image, at) },
+    };
+    memset(&image[crc_at], 0, sizeof(uint16_t));
+    ranges[2].crc = imagecrc_compute(image, len);
+
+    printf("crc            %04X\n", crc_field);
+    for (uint32_t r = 0; r < sizeof(ranges) / sizeof(ranges[0]); r++)
+    {
+        printf("  %-26s %04X%s\n", ranges[r].name, ranges[r].crc, (ranges[r].crc == crc_field) ? " match" : "");
+    }
+    // The range of the boot check
+    if (ranges[0].crc != crc_field)
+    {
+        fprintf(stderr, "%s: crc %04X is not the crc of the image without the header %04X\n",
+                path, crc_field, ranges[0].crc);
+        result = 1;
+    }
+    free(image);
+    return result;
+}
+
+static void usage (void)
+{
+    fprintf(stderr, "usage: appheader_check [-e field=value]... [-i image.bin] header.bin [other.bin]\n");
+}
+
+int main (int argc, char * argv[])
+{
+    const char * expect[APPHEADER_CHECK_MAX_EXPECT];
+    uint32_t expect_count = 0;
+    const char * files[2];
+    uint32_t file_count = 0;
+    const char * image = NULL;
+    int result = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if ((strcmp(argv[i], "-e") == 0) && (i + 1 < argc) && (expect_count < APPHEADER_CHECK_MAX_EXPECT))
+        {
+            expect[expect_count++] = argv[++i];
+        }
+        else if ((strcmp(argv[i], "-i") == 0) && (i + 1 < argc))
+        {
+            image = argv[++i];
+        }
+        else if ((argv[i][0] != '-') && (file_count < 2))
+        {
+            files[file_count++] = argv[i];
+        }
+        else
+        {
+            usage();
+            return 2;
+        }
+    }
+    if (file_count == 0)
+    {
+        usage();
+        return 2;
+    }
+
+    uint8_t * data[2] = { NULL, NULL };
+    const appheader_t * h[2] = { NULL, NULL };
+    for (uint32_t i = 0; i < file_count; i++)
+    {
+        h[i] = load_header(files[i], &data[i]);
+        if (h[i] == NULL)
+        {
+            result = 1;
+        }
+    }
+
+    if ((image != NULL) && (h[0] != NULL))
+    {
+        imagecrc_init();
+        if (check_image(image, h[0]) != 0)
+        {
+            result = 1;
+        }
+    }
+    else if ((file_count == 1) && (h[0] != NULL))
+    {
+        for (uint32_t f = 0; f < FIELD_COUNT; f++)
+        {
+            printf("%-14s ", m_fields[f].name);
+            field_print(stdout, data[0], &m_fields[f]);
+            printf("\n");
+        }
+    }
+    else if ((file_count == 2) && (h[0] != NULL) && (h[1] != NULL))
+    {
+        for (uint32_t f = 0; f < FIELD_COUNT; f++)
+        {
+            const field_t * field = &m_fields[f];
+            if (memcmp(&data[0][field->offset], &data[1][field->offset], field->size) != 0)
+            {
+                printf("%-14s ", field->name);
+                field_print(stdout, data[0], field);
+                printf(" -> ");
+                field_print(stdout, data[1], field);
+                printf("\n");
+                result = 1;
+            }
+        }
+    }
+
+    for (uint32_t e = 0; (e < expect_count) && (h[0] != NULL); e++)
+    {
+        const char * value = strchr(expect[e], '=');
+        const field_t * field = (value != NULL) ? field_find(expect[e], (size_t)(value - expect[e])) : NULL;
+        if (field == NULL)
+        {
+            fprintf(stderr, "%s: unknown field\n", expect[e]);
+            result = 2;
+        }
+        else if (!field_equal(data[0], field, value + 1))
+        {
+            fprintf(stderr, "%s: %s is ", files[0], field->name);
+            field_print(stderr, data[0], field);
+            fprintf(stderr, ", expected %s\n", value + 1);
+            result = 1;
+        }
+    }
+
+    free(data[0]);
+    free(data[1]);
+    return result;
+}
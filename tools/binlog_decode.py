@@ -0,0 +1,97 @@
+#!/usr/bin/env python3
+"""
+Decode an esw-gpio binary log stream (LOGGER_BINLOG=1).
+
+Format strings are looked up in the .binlog_fmt section of the firmware
+ELF file that produced the stream. The stream is read from a file or a
+serial port dump, text records are printed as they are.
+
+    binlog_decode.py build/tsb0/esw-gpio.elf log.bin
+    cat /dev/ttyUSB0 | binlog_decode.py build/tsb0/esw-gpio.elf -
+"""
+import argparse
+import re
+import struct
+import sys
+
+BINLOG_TEXT = 0xB0
+BINLOG_RECORD = 0xB1
+
+# printf conversions, length modifiers are dropped for Python formatting
+CONVERSION = re.compile(r"%([-+ #0]*\d*(?:\.\d+)?)(?:hh|h|ll|l|z|j|t)?([diouxXc%])")
+
+
+def read_format_section(elf_path, name=".binlog_fmt"):
+    with open(elf_path, "rb") as f:
+        elf = f.read()
+    if elf[:4] != b"\x7fELF" or elf[4] != 1 or elf[5] != 1:
+        raise ValueError("not a 32-bit little endian ELF file")
+    shoff, = struct.unpack_from("<I", elf, 0x20)
+    shentsize, shnum, shstrndx = struct.unpack_from("<HHH", elf, 0x2E)
+
+    def header(i):
+        return struct.unpack_from("<IIIIIIIIII", elf, shoff + i * shentsize)
+
+    strtab = header(shstrndx)
+    for i in range(shnum):
+        sh = header(i)
+        start = strtab[4] + sh[0]
+        if elf[start:elf.index(b"\0", start)].decode() == name:
+            return sh[3], elf[sh[4]:sh[4] + sh[5]]
+    raise ValueError("no %s section, was the image built with LOGGER_BINLOG=1?" % name)
+
+
+def expand(fmt, args):
+    values = iter(args)
+
+    def convert(m):
+        flags, conv = m.group(1), m.group(2)
+        if conv == "%":
+            return "%"
+        value = next(values, 0)
+        if conv in "di" and value & 0x80000000:
+            value -= 1 << 32
+        if conv == "u":
+            conv = "d"
+        elif conv == "c":
+            value = chr(value & 0xFF)
+        return ("%" + flags + conv) % value
+
+    return CONVERSION.sub(convert, fmt)
+
+
+def decode(stream, base, strings, out):
+    while True:
+        kind = stream.read(1)
+        if not kind:
+            return
+        if kind[0] == BINLOG_TEXT:
+            length = stream.read(1)[0]
+            out.write(stream.read(length).decode(errors="replace"))
+        elif kind[0] == BINLOG_RECORD:
+            count = stream.read(1)[0]
+            address, tick = struct.unpack("<II", stream.read(8))
+            args = struct.unpack("<%dI" % count, stream.read(4 * count))
+            offset = address - base
+            end = strings.find(b"\0", offset)
+            if offset < 0 or end < 0:
+                out.write("%10d ? unknown format 0x%08X %s\n" % (tick, address, args))
+                continue
+            level, module, fmt = strings[offset:end].decode().split("|", 2)
+            out.write("%10d %s|%4s| %s\n" % (tick, level, module, expand(fmt, args)))
+        # Anything else is noise before the first record, resynchronize
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("elf", help="firmware ELF file")
+    parser.add_argument("log", help="binary log stream, - for stdin")
+    args = parser.parse_args()
+
+    base, strings = read_format_section(args.elf)
+    stream = sys.stdin.buffer if args.log == "-" else open(args.log, "rb")
+    decode(stream, base, strings, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()